@@ -0,0 +1,600 @@
+// Microbenchmarks for the decision kernels, linked against the engine
+// library; allocations are counted by replacing the global operator new.
+#include "tbs/engine.h"
+#include "tbs/training.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <new>
+
+using namespace tbs;
+
+// how the build was optimized (build type, PGO, LTO), set by CMake
+#ifndef TBS_BUILD_FLAVOR
+#define TBS_BUILD_FLAVOR "unknown"
+#endif
+
+// with TBS_WORK_COUNTERS the engine already counts allocations per thread
+#ifndef TBS_WORK_COUNTERS
+namespace {
+
+thread_local uint64_t threadAllocations = 0;
+
+}
+
+void* operator new(std::size_t size) {
+    ++threadAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC cannot tell that these pair with the operator new above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// keeps the benchmarked results alive
+volatile double sink;
+
+// both fleets at one point of a seeded game
+struct Fixture {
+    std::string name;
+    Player p1;
+    Player p2;
+    int round;
+};
+
+int livingShips(const Player& player) {
+    int count = 0;
+    for (const Ship& ship : player.getShips()) count += !ship.isDead();
+    return count;
+}
+
+int totalHealth(const Player& player) {
+    int health = 0;
+    for (const Ship& ship : player.getShips()) health += ship.getHealth();
+    return health;
+}
+
+// Plays one seeded game and keeps the fleets right after placement (early:
+// spread-out fleets), after the first round in which a ship was hit (mid-game
+// contact) and after the last round (endgame).
+std::vector<Fixture> makeFixtures(uint64_t seed) {
+    Game game(findStrategy("Aggressive"), findStrategy("Balanced"), seed);
+    game.start();
+
+    std::vector<Fixture> fixtures;
+    fixtures.push_back({"early", game.getPlayer(1), game.getPlayer(2), 0});
+    bool contact = false;
+    int health = totalHealth(game.getPlayer(1)) + totalHealth(game.getPlayer(2));
+    Fixture last = fixtures.front();
+
+    while (!game.isGameOver()) {
+        game.beginRound();
+        game.playPhase(GamePhase::P1_ATTACK_CHOICE);
+        game.playPhase(GamePhase::P2_MOVE);
+        game.playPhase(GamePhase::P1_RESOLVE);
+        if (!game.isGameOver()) {
+            game.playPhase(GamePhase::P2_ATTACK_CHOICE);
+            game.playPhase(GamePhase::P1_MOVE);
+            game.playPhase(GamePhase::P2_RESOLVE);
+        }
+
+        last = {"endgame", game.getPlayer(1), game.getPlayer(2), game.getRound()};
+        int newHealth = totalHealth(game.getPlayer(1)) + totalHealth(game.getPlayer(2));
+        if (!contact && newHealth < health && !game.isGameOver()) {
+            fixtures.push_back({"mid", game.getPlayer(1), game.getPlayer(2), game.getRound()});
+            contact = true;
+        }
+        health = newHealth;
+    }
+    if (!contact) {
+        throw std::runtime_error("seed " + std::to_string(seed) + " has no contact before the end");
+    }
+    fixtures.push_back(last);
+    return fixtures;
+}
+
+struct Measurement {
+    uint64_t ops = 0;
+    double seconds = 0;
+    uint64_t allocations = 0;
+};
+
+// Calls op(i) for i = 0, 1, ... in doubling batches until minSeconds have passed.
+template <typename Op>
+Measurement measure(double minSeconds, Op op) {
+    op(0); // warm up
+    Measurement m;
+    uint64_t batch = 1;
+    while (m.seconds < minSeconds) {
+        uint64_t allocationsBefore = threadAllocations;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; ++i) op(m.ops + i);
+        m.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        m.allocations += threadAllocations - allocationsBefore;
+        m.ops += batch;
+        batch *= 2;
+    }
+    return m;
+}
+
+void report(const std::string& fixture, const std::string& kernel, const Measurement& m) {
+    std::cout << std::left << std::setw(9) << fixture << std::setw(22) << kernel << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14) << m.seconds * 1e9 / m.ops
+              << std::setw(14) << std::setprecision(0) << m.ops / m.seconds
+              << std::setw(12) << std::setprecision(2)
+              << static_cast<double>(m.allocations) / m.ops << "\n";
+}
+
+// the living ships of a player, as the mutable references the kernels expect
+std::vector<Ship*> livingShipsOf(Player& player) {
+    std::vector<Ship*> result;
+    for (Ship& ship : const_cast<std::vector<Ship>&>(player.getShips())) {
+        if (!ship.isDead()) result.push_back(&ship);
+    }
+    return result;
+}
+
+void benchmarkFixture(Fixture& f, double minSeconds) {
+    std::vector<Ship*> own = livingShipsOf(f.p1);
+    std::vector<Ship*> enemies = livingShipsOf(f.p2);
+    if (own.empty() || enemies.empty()) return;
+
+    std::vector<Ship*> armed;
+    for (Ship* ship : own) {
+        if (ship->getCrossMissiles() > 0 || ship->getSquareMissiles() > 0) armed.push_back(ship);
+    }
+    if (armed.empty()) armed = own;
+
+    // every cell the enemy can reach, as evaluateAttack sees them in chooseAttackPosition
+    std::vector<Position> targets;
+    for (Ship* enemy : enemies) {
+        for (const Position& pos : enemy->getPossibleMoves()) targets.push_back(pos);
+    }
+    std::vector<std::pair<Ship*, Position>> moves;
+    for (Ship* ship : own) {
+        for (const Position& pos : ship->getPossibleMoves()) moves.emplace_back(ship, pos);
+    }
+
+    const std::string& label = f.name;
+    report(label, "chooseAttackPosition", measure(minSeconds, [&](uint64_t i) {
+        sink = f.p1.chooseAttackPosition(*armed[i % armed.size()], f.p2).score;
+    }));
+    report(label, "evaluateAttack", measure(minSeconds, [&](uint64_t i) {
+        std::string explanation;
+        Missile::Type type = (i / targets.size()) % 2 ? Missile::SQUARE : Missile::CROSS;
+        sink = f.p1.evaluateAttack(targets[i % targets.size()], f.p2, type, explanation);
+    }));
+    report(label, "chooseMovePosition", measure(minSeconds, [&](uint64_t i) {
+        sink = f.p1.chooseMovePosition(*own[i % own.size()], f.p2).score;
+    }));
+    report(label, "evaluateMove", measure(minSeconds, [&](uint64_t i) {
+        std::string explanation;
+        const auto& [ship, pos] = moves[i % moves.size()];
+        sink = f.p1.evaluateMove(pos, *ship, f.p2, explanation);
+    }));
+    report(label, "Missile::getDamageArea", measure(minSeconds, [&](uint64_t i) {
+        Missile missile((i / targets.size()) % 2 ? Missile::SQUARE : Missile::CROSS);
+        sink = static_cast<double>(missile.getDamageArea(targets[i % targets.size()]).size());
+    }));
+}
+
+// ---- regression gate ------------------------------------------------------
+//
+// A fixed seeded workload is played --runs times. Each run yields one value
+// per metric; the gate compares the median over runs with the baseline and
+// allows for the noise (median absolute deviation) both sides measured.
+
+const int GATE_BASELINE_VERSION = 1;
+const double GATE_MIN_TOLERANCE = 0.10;    // relative change always accepted
+const double GATE_NOISE_FACTOR = 3.0;      // noise multiples accepted on top
+const double GATE_MIN_LATENCY_US = 50.0;   // latency rises below this are scheduler noise
+
+// the values of every metric, one per run
+using GateSamples = std::map<std::string, std::vector<double>>;
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+double median(const std::vector<double>& values) { return percentile(values, 0.5); }
+
+// median absolute deviation relative to the median
+double relativeNoise(const std::vector<double>& values) {
+    double m = median(values);
+    if (m == 0) return 0;
+    std::vector<double> deviations;
+    for (double v : values) deviations.push_back(std::abs(v - m));
+    return median(deviations) / std::abs(m);
+}
+
+// snake_case name of a round phase, e.g. p1_attack_choice
+std::string phaseKey(int phase) {
+    std::string key = PHASE_NAMES[phase];
+    for (char& c : key) c = c == ' ' ? '_' : static_cast<char>(std::tolower(c));
+    return key;
+}
+
+// Plays a game phase by phase, recording the latency of every phase.
+Game::GameResult playTimed(Game& game, std::array<std::vector<double>, TIMED_PHASE_COUNT>& latencies) {
+    auto play = [&](GamePhase phase) {
+        auto start = std::chrono::steady_clock::now();
+        game.playPhase(phase);
+        latencies[static_cast<int>(phase) - 1].push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    };
+    auto start = std::chrono::steady_clock::now();
+    game.start();
+    while (!game.isGameOver()) {
+        game.beginRound();
+        play(GamePhase::P1_ATTACK_CHOICE);
+        play(GamePhase::P2_MOVE);
+        play(GamePhase::P1_RESOLVE);
+        if (game.isGameOver()) break;
+        play(GamePhase::P2_ATTACK_CHOICE);
+        play(GamePhase::P1_MOVE);
+        play(GamePhase::P2_RESOLVE);
+    }
+    return game.finish(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+// Runs one workload, calling playGames(play) where play(game) plays and
+// times one game, and appends its metrics to samples.
+template <typename Workload>
+void runGateWorkload(const std::string& name, GateSamples& samples, Workload playGames) {
+    std::array<std::vector<double>, TIMED_PHASE_COUNT> latencies;
+    uint64_t games = 0;
+    uint64_t allocationsBefore = threadAllocations;
+    auto start = std::chrono::steady_clock::now();
+    playGames([&](Game& game) {
+        ++games;
+        return playTimed(game, latencies);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    samples[name + ".games_per_sec"].push_back(games / seconds);
+    samples[name + ".allocs_per_game"].push_back(
+        static_cast<double>(threadAllocations - allocationsBefore) / games);
+    for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+        if (latencies[phase].empty()) continue;
+        samples[name + ".p50_us." + phaseKey(phase + 1)].push_back(percentile(latencies[phase], 0.5));
+        samples[name + ".p99_us." + phaseKey(phase + 1)].push_back(percentile(latencies[phase], 0.99));
+    }
+}
+
+// One run of the gate workload: a round-robin tournament slice, a slice of
+// QAgent training against Balanced and a game with doubled fleets.
+void runGateWorkloads(uint64_t seed, GateSamples& samples) {
+    const std::vector<std::string> STRATEGIES = {"Aggressive", "Balanced", "Defensive"};
+    GameConfig shortGame;
+    shortGame.maxRounds = 8;
+
+    runGateWorkload("tournament", samples, [&](auto play) {
+        for (size_t i = 0; i < STRATEGIES.size(); ++i) {
+            for (size_t j = 0; j < STRATEGIES.size(); ++j) {
+                Game game(findStrategy(STRATEGIES[i]), findStrategy(STRATEGIES[j]),
+                          mixSeed(seed, i, j), shortGame);
+                play(game);
+            }
+        }
+    });
+
+    runGateWorkload("training", samples, [&](auto play) {
+        QAgent agent("gate", true);
+        agent.setVerbose(false);
+        agent.seedRandom(seed);
+        for (int episode = 0; episode < 6; ++episode) {
+            StrategyParams params = agent.getAction();
+            Game game(params, findStrategy("Balanced"), mixSeed(seed, episode), shortGame);
+            agent.update(params, computeReward(play(game), true));
+        }
+    });
+
+    GameConfig largeFleet;
+    largeFleet.maxRounds = 3;
+    largeFleet.fleetScale = 2;
+    runGateWorkload("large_fleet", samples, [&](auto play) {
+        Game game(findStrategy("Aggressive"), findStrategy("Balanced"), seed, largeFleet);
+        play(game);
+    });
+}
+
+struct GateMetric {
+    double value = 0;
+    double noise = 0;
+};
+
+struct GateBaseline {
+    uint64_t seed = 0;
+    std::string build = "unknown";  // TBS_BUILD_FLAVOR of the build that wrote it
+    std::map<std::string, GateMetric> metrics;
+};
+
+void writeGateBaseline(const std::string& path, uint64_t seed, int runs, const GateSamples& samples) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    out << "{\n  \"version\": " << GATE_BASELINE_VERSION << ",\n  \"build\": \"" << TBS_BUILD_FLAVOR
+        << "\",\n  \"seed\": " << seed << ",\n  \"runs\": " << runs << ",\n  \"metrics\": {";
+    const char* separator = "\n";
+    out << std::setprecision(10);
+    for (const auto& [name, values] : samples) {
+        out << separator << "    \"" << name << "\": {\"value\": " << median(values)
+            << ", \"noise\": " << relativeNoise(values) << "}";
+        separator = ",\n";
+    }
+    out << "\n  }\n}\n";
+}
+
+// Reads the files writeGateBaseline writes: objects, strings and numbers.
+class GateBaselineReader {
+public:
+    explicit GateBaselineReader(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("cannot open baseline " + path);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    GateBaseline read() {
+        GateBaseline baseline;
+        int version = 0;
+        readObject([&](const std::string& key) {
+            if (key == "version") version = static_cast<int>(readNumber());
+            else if (key == "build") baseline.build = readString();
+            else if (key == "seed") baseline.seed = static_cast<uint64_t>(readNumber());
+            else if (key == "runs") readNumber();
+            else if (key == "metrics") {
+                readObject([&](const std::string& name) {
+                    GateMetric& metric = baseline.metrics[name];
+                    readObject([&](const std::string& field) {
+                        if (field == "value") metric.value = readNumber();
+                        else if (field == "noise") metric.noise = readNumber();
+                        else fail("unknown metric field " + field);
+                    });
+                });
+            } else fail("unknown key " + key);
+        });
+        if (version != GATE_BASELINE_VERSION) {
+            fail("version " + std::to_string(version) + " is not supported");
+        }
+        return baseline;
+    }
+
+private:
+    std::string text;
+    size_t pos = 0;
+
+    [[noreturn]] void fail(const std::string& message) {
+        throw std::runtime_error("baseline: " + message + " (offset " + std::to_string(pos) + ")");
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) fail(std::string("expected '") + c + "'");
+        ++pos;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return pos < text.size() && text[pos] == c;
+    }
+
+    std::string readString() {
+        expect('"');
+        size_t end = text.find('"', pos);
+        if (end == std::string::npos) fail("unterminated string");
+        std::string value = text.substr(pos, end - pos);
+        pos = end + 1;
+        return value;
+    }
+
+    double readNumber() {
+        skipSpace();
+        size_t used = 0;
+        double value;
+        try {
+            value = std::stod(text.substr(pos, 32), &used);
+        } catch (const std::exception&) {
+            fail("expected a number");
+        }
+        pos += used;
+        return value;
+    }
+
+    // calls onKey(key) with the position at each value of an object
+    template <typename OnKey>
+    void readObject(OnKey onKey) {
+        expect('{');
+        if (peek('}')) {
+            ++pos;
+            return;
+        }
+        while (true) {
+            std::string key = readString();
+            expect(':');
+            onKey(key);
+            if (!peek(',')) break;
+            ++pos;
+        }
+        expect('}');
+    }
+};
+
+// Compares the median of each metric with the baseline. Throughput may drop
+// and latencies and allocations may rise by the larger of GATE_MIN_TOLERANCE
+// and GATE_NOISE_FACTOR times the noise either side measured. Returns false
+// on any regression.
+bool compareWithBaseline(const GateBaseline& baseline, const GateSamples& samples) {
+    bool passed = true;
+    std::cout << std::left << std::setw(40) << "metric" << std::right << std::setw(14) << "baseline"
+              << std::setw(14) << "current" << std::setw(10) << "change" << std::setw(10)
+              << "allowed" << "\n";
+    for (const auto& [name, values] : samples) {
+        auto it = baseline.metrics.find(name);
+        if (it == baseline.metrics.end()) {
+            std::cout << std::left << std::setw(40) << name << std::right << std::setw(14) << "-"
+                      << "  not in the baseline\n";
+            continue;
+        }
+        const GateMetric& base = it->second;
+        double current = median(values);
+        double change = base.value == 0 ? 0 : (current - base.value) / base.value;
+        double allowed = std::max(GATE_MIN_TOLERANCE,
+                                  GATE_NOISE_FACTOR * std::max(base.noise, relativeNoise(values)));
+
+        bool higherIsBetter = name.find("games_per_sec") != std::string::npos;
+        bool latency = name.find("_us.") != std::string::npos;
+        bool regressed = higherIsBetter ? change < -allowed : change > allowed;
+        if (latency && current - base.value < GATE_MIN_LATENCY_US) regressed = false;
+        if (base.value == 0 && current > 0 && !higherIsBetter && !latency) regressed = true;
+        passed &= !regressed;
+
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14) << base.value << std::setw(14) << current
+                  << std::setprecision(1) << std::setw(9) << change * 100 << "%" << std::setw(9)
+                  << allowed * 100 << "%" << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    for (const auto& [name, metric] : baseline.metrics) {
+        if (!samples.count(name)) {
+            std::cout << std::left << std::setw(40) << name << std::right
+                      << "  in the baseline but not measured\n";
+        }
+    }
+
+    // throughput ratios, e.g. of a PGO build against a baseline written by the plain build
+    std::cout << "\nSpeedup of this build (" << TBS_BUILD_FLAVOR << ") over the baseline ("
+              << baseline.build << "), games/sec:";
+    double logSum = 0;
+    int workloads = 0;
+    for (const auto& [name, values] : samples) {
+        size_t suffix = name.find(".games_per_sec");
+        auto it = baseline.metrics.find(name);
+        if (suffix == std::string::npos || it == baseline.metrics.end() || it->second.value <= 0) continue;
+        double speedup = median(values) / it->second.value;
+        std::cout << " " << name.substr(0, suffix) << " " << std::setprecision(2) << speedup << "x";
+        logSum += std::log(speedup);
+        ++workloads;
+    }
+    if (workloads > 0) std::cout << ", geometric mean " << std::exp(logSum / workloads) << "x";
+    std::cout << "\n";
+
+    std::cout << (passed ? "No performance regression\n" : "Performance regression gate FAILED\n");
+    return passed;
+}
+
+// --gate / --write-baseline: plays the gate workload `runs` times, then
+// compares with or rewrites the baseline. Returns the exit code.
+int runRegressionGate(const std::string& baselinePath, bool write, uint64_t seed, int runs) {
+    GateBaseline baseline;
+    if (!write) {
+        baseline = GateBaselineReader(baselinePath).read();
+        seed = baseline.seed;
+    }
+
+    std::cout << "Regression gate workload, seed " << seed << ", " << runs << " runs, "
+              << TBS_BUILD_FLAVOR << " build\n";
+    GateSamples samples;
+    runGateWorkloads(seed, samples);  // warm up caches and the allocator
+    samples.clear();
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        runGateWorkloads(seed, samples);
+        std::cout << "  run " << run + 1 << ": " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                  << " s\n";
+    }
+    std::cout << "\n";
+
+    if (write) {
+        writeGateBaseline(baselinePath, seed, runs, samples);
+        std::cout << "Wrote " << samples.size() << " metrics to " << baselinePath << "\n";
+        return 0;
+    }
+    return compareWithBaseline(baseline, samples) ? 0 : 1;
+}
+
+void printBenchmarkUsage() {
+    std::cout << "Usage: TurnBaseShipBenchmark [options]\n"
+              << "  --seed N        seed of the fixture game and the Game::run games (default 1)\n"
+              << "  --min-time S    seconds each kernel is timed for (default 0.5)\n"
+              << "  --games N       minimum Game::run games (default 3)\n"
+              << "  --gate FILE     play the regression gate workload and compare with the baseline FILE;\n"
+              << "                  exits with 1 on a regression\n"
+              << "  --write-baseline FILE  play the gate workload and write its metrics to FILE\n"
+              << "  --runs N        runs of the gate workload (default 5)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    double minSeconds = 0.5;
+    int games = 3;
+    std::string baselinePath;
+    bool writeBaseline = false;
+    int runs = 5;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error(arg + " expects a value");
+                return argv[++i];
+            };
+
+            if (arg == "--seed") seed = std::stoull(value());
+            else if (arg == "--min-time") minSeconds = std::stod(value());
+            else if (arg == "--games") games = std::max(1, std::stoi(value()));
+            else if (arg == "--gate") baselinePath = value();
+            else if (arg == "--write-baseline") { baselinePath = value(); writeBaseline = true; }
+            else if (arg == "--runs") runs = std::max(1, std::stoi(value()));
+            else if (arg == "--help") { printBenchmarkUsage(); return 0; }
+            else throw std::runtime_error("unknown option " + arg);
+        }
+
+        if (!baselinePath.empty()) return runRegressionGate(baselinePath, writeBaseline, seed, runs);
+
+        std::vector<Fixture> fixtures = makeFixtures(seed);
+        std::cout << "Decision kernel benchmarks, Aggressive (P1) vs Balanced (P2), seed " << seed
+                  << ", " << TBS_BUILD_FLAVOR << " build\n\n"
+                  << std::left << std::setw(9) << "fixture" << std::setw(22) << "kernel" << std::right
+                  << std::setw(14) << "ns/op" << std::setw(14) << "ops/sec"
+                  << std::setw(12) << "allocs/op" << "\n";
+        for (Fixture& fixture : fixtures) {
+            std::cout << std::left << "-- " << fixture.name << ": round " << fixture.round << ", "
+                      << livingShips(fixture.p1) << " vs " << livingShips(fixture.p2)
+                      << " ships\n" << std::right;
+            benchmarkFixture(fixture, minSeconds);
+        }
+
+        // whole games on successive seeds, so each op is a different game
+        Measurement m;
+        for (int g = 0; g < games; ++g) {
+            Game game(findStrategy("Aggressive"), findStrategy("Balanced"), mixSeed(seed, g));
+            uint64_t allocationsBefore = threadAllocations;
+            auto start = std::chrono::steady_clock::now();
+            sink = game.run().rounds;
+            m.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            m.allocations += threadAllocations - allocationsBefore;
+            m.ops += 1;
+        }
+        report("game", "Game::run", m);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printBenchmarkUsage();
+        return 1;
+    }
+    return 0;
+}
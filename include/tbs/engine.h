@@ -0,0 +1,1822 @@
+// Public API of the naval battle engine (the TurnBaseShipEngine library):
+// the game model, the game executor, BatchedEnv and the runners behind the
+// TurnBaseShipSimulator modes. Builds that link the library must use the same
+// TBS_WORK_COUNTERS and TBS_RDTSC_TIMERS definitions as the library itself;
+// the CMake targets propagate them. Everything is declared in namespace tbs.
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <sstream>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <new>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef TBS_RDTSC_TIMERS
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace tbs {
+
+const int MAP_SIZE = 256;
+const int MAX_ROUNDS = 100;
+const bool VERBOSE_OUTPUT = false;
+const double EPSILON = 1e-6;
+
+// How much work a player's decisions did in a game. Counted only in builds
+// with TBS_WORK_COUNTERS; COUNT_WORK compiles to nothing otherwise.
+struct WorkCounters {
+    uint64_t targetsEvaluated = 0;  // candidate attack targets scored
+    uint64_t rayTests = 0;          // Ray::distanceAndProjection calls
+    uint64_t reachableCells = 0;    // cells produced by Ship::getPossibleMoves
+    uint64_t movesScored = 0;       // evaluateMove calls
+    uint64_t allocations = 0;       // heap allocations
+    uint64_t allocatedBytes = 0;    // bytes requested by those allocations
+    uint64_t attacksIssued = 0;
+    uint64_t attacksTriggered = 0;
+
+    WorkCounters& operator+=(const WorkCounters& other) {
+        targetsEvaluated += other.targetsEvaluated;
+        rayTests += other.rayTests;
+        reachableCells += other.reachableCells;
+        movesScored += other.movesScored;
+        allocations += other.allocations;
+        allocatedBytes += other.allocatedBytes;
+        attacksIssued += other.attacksIssued;
+        attacksTriggered += other.attacksTriggered;
+        return *this;
+    }
+};
+
+// Heap allocations and their bytes, e.g. of one round phase.
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationCounts& operator+=(const AllocationCounts& other) {
+        allocations += other.allocations;
+        bytes += other.bytes;
+        return *this;
+    }
+
+    AllocationCounts operator-(const AllocationCounts& other) const {
+        return {allocations - other.allocations, bytes - other.bytes};
+    }
+};
+
+#ifdef TBS_WORK_COUNTERS
+// the counters of the player whose phase this thread is playing, if any
+inline thread_local WorkCounters* activeWorkCounters = nullptr;
+
+// heap allocations made by this thread and their bytes, counted by the global
+// operator new of src/allocation_hook.cpp; they stay zero in programs that do
+// not link that hook
+inline thread_local uint64_t threadAllocations = 0;
+inline thread_local uint64_t threadAllocatedBytes = 0;
+
+inline AllocationCounts threadAllocationCounts() { return {threadAllocations, threadAllocatedBytes}; }
+
+// live and peak heap bytes of the process
+inline std::atomic<int64_t> liveHeapBytes{0};
+inline std::atomic<int64_t> peakHeapBytes{0};
+
+inline void resetPeakHeapBytes() { peakHeapBytes = liveHeapBytes.load(); }
+
+// A function whose allocations ALLOCATION_SCOPE attributes to it, nested
+// scopes included. Sites register themselves in a process-wide list.
+struct AllocationSite {
+    const char* name;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    AllocationSite* next = nullptr;
+
+    static inline std::atomic<AllocationSite*> head{nullptr};
+
+    explicit AllocationSite(const char* name) : name(name) {
+        next = head.load();
+        while (!head.compare_exchange_weak(next, this)) {}
+    }
+};
+
+class AllocationScope {
+public:
+    explicit AllocationScope(AllocationSite& site)
+        : site(site), before(threadAllocationCounts()) {}
+
+    ~AllocationScope() {
+        AllocationCounts allocated = threadAllocationCounts() - before;
+        site.calls.fetch_add(1, std::memory_order_relaxed);
+        site.allocations.fetch_add(allocated.allocations, std::memory_order_relaxed);
+        site.bytes.fetch_add(allocated.bytes, std::memory_order_relaxed);
+    }
+
+private:
+    AllocationSite& site;
+    AllocationCounts before;
+};
+
+#define COUNT_WORK(field, n) \
+    do { if (::tbs::activeWorkCounters) ::tbs::activeWorkCounters->field += (n); } while (0)
+#define ALLOCATION_SCOPE(name) \
+    static ::tbs::AllocationSite allocationSite(name); \
+    ::tbs::AllocationScope allocationScope(allocationSite)
+#else
+#define COUNT_WORK(field, n) ((void)0)
+#define ALLOCATION_SCOPE(name) ((void)0)
+#endif
+
+// Board and fleet dimensions of a game. The defaults are the standard game;
+// the scalability sweep varies them.
+struct GameConfig {
+    int mapSize = MAP_SIZE;
+    int maxRounds = MAX_ROUNDS;
+    int fleetScale = 1;       // every ship group of both fleets is repeated this many times
+    int moveRangeBonus = 0;   // added to every ship's move range
+};
+
+struct StrategyParams {
+    double healthWeight;
+    double missileWeight;
+    double blockWeight;
+    double targetWeight;
+    double enemyDistanceWeight;
+    double allyDistanceWeight;
+    double attackThreshold;
+
+
+    StrategyParams(bool isFirstPlayer) {
+        if (isFirstPlayer) {
+            healthWeight = -1.896;
+            missileWeight =  1.594;
+            blockWeight = -0.790;
+            targetWeight = -1.110;
+            enemyDistanceWeight = -0.478;
+            allyDistanceWeight = -1.598;
+            attackThreshold= -1.772;
+        } else {
+            healthWeight = -1.583;
+            missileWeight =  1.054;
+            blockWeight =   1.130;
+            targetWeight = -1.348;
+            enemyDistanceWeight = -0.641;
+            allyDistanceWeight =  -0.301;
+            attackThreshold= 0.108;
+        }
+    }
+
+    StrategyParams(double hw, double mw, double bw, double tw, double ew, double aw,double at)
+        : healthWeight(hw), missileWeight(mw), blockWeight(bw),
+          targetWeight(tw), enemyDistanceWeight(ew), allyDistanceWeight(aw) ,attackThreshold(at){}
+};
+
+
+struct Position {
+    int x, y;
+    Position(int _x = 0, int _y = 0) : x(_x), y(_y) {}
+
+    bool operator==(const Position& other) const {
+        return x == other.x && y == other.y;
+    }
+
+    double distanceTo(const Position& other) const {
+        return std::sqrt(std::pow(x - other.x, 2) + std::pow(y - other.y, 2));
+    }
+
+
+    Position operator+(const Position& other) const {
+        return Position(x + other.x, y + other.y);
+    }
+
+    Position operator-(const Position& other) const {
+        return Position(x - other.x, y - other.y);
+    }
+
+    Position operator*(double scalar) const {
+        return Position(static_cast<int>(x * scalar), static_cast<int>(y * scalar));
+    }
+
+    double dot(const Position& other) const {
+        return x * other.x + y * other.y;
+    }
+
+    double length() const {
+        return std::sqrt(x * x + y * y);
+    }
+};
+
+struct Ray {
+    Position origin;
+    Position direction;
+
+    Ray(const Position& from, const Position& to)
+        : origin(from), direction(to - from) {}
+
+    std::pair<double, double> distanceAndProjection(const Position& point) const {
+        COUNT_WORK(rayTests, 1);
+        Position v = point - origin;
+        double t = v.dot(direction) / direction.dot(direction);
+
+
+        Position projection = origin + direction * t;
+        double distance = point.distanceTo(projection);
+
+        return {distance, t};
+    }
+};
+
+
+
+class Missile {
+public:
+    enum Type { CROSS, SQUARE };
+
+private:
+    Type type;
+    int mapSize;
+
+public:
+    Missile(Type t, int mapSize = MAP_SIZE) : type(t), mapSize(mapSize) {}
+
+    std::vector<Position> getDamageArea(const Position& target) const {
+        ALLOCATION_SCOPE("Missile::getDamageArea");
+        std::vector<Position> area;
+        if (type == CROSS) {
+            const int dx[] = {0, 1, 0, -1, 0};
+            const int dy[] = {0, 0, 1, 0, -1};
+            for (int i = 0; i < 5; ++i) {
+                Position pos(target.x + dx[i], target.y + dy[i]);
+                if (isValidPosition(pos)) {
+                    area.push_back(pos);
+                }
+            }
+        } else {
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    Position pos(target.x + dx, target.y + dy);
+                    if (isValidPosition(pos)) {
+                        area.push_back(pos);
+                    }
+                }
+            }
+        }
+        return area;
+    }
+
+    Type getType() const { return type; }
+
+private:
+    bool isValidPosition(const Position& pos) const {
+        return pos.x >= 0 && pos.x < mapSize && pos.y >= 0 && pos.y < mapSize;
+    }
+};
+
+class Ship {
+public:
+    Ship(int maxHp, int moveRange, int crossMissiles, int squareMissiles, int mapSize = MAP_SIZE)
+        : maxHealth(maxHp), health(maxHp), moveRange(moveRange),
+          remainingCrossMissiles(crossMissiles),
+          remainingSquareMissiles(squareMissiles), mapSize(mapSize) {}
+
+    bool isDead() const { return health <= 0; }
+    int getHealth() const { return health; }
+    int getMaxHealth() const { return maxHealth; }
+    int getMoveRange() const { return moveRange; }
+    int getCrossMissiles() const { return remainingCrossMissiles; }
+    int getSquareMissiles() const { return remainingSquareMissiles; }
+    Position getPosition() const { return position; }
+
+    void setPosition(const Position& pos) {
+        position = pos;
+        cachedMoves.clear();
+    }
+
+    void takeDamage(int damage) { health = std::max(0, health - damage); }
+
+    bool useMissile(Missile::Type type) {
+        if (type == Missile::CROSS && remainingCrossMissiles > 0) {
+            --remainingCrossMissiles;
+            return true;
+        } else if (type == Missile::SQUARE && remainingSquareMissiles > 0) {
+            --remainingSquareMissiles;
+            return true;
+        }
+        return false;
+    }
+
+    double getValue(const StrategyParams& params) const {
+        return (health * params.healthWeight +
+                (remainingCrossMissiles + remainingSquareMissiles) *
+                params.missileWeight);
+    }
+
+    std::vector<Position> getPossibleMoves() {
+        ALLOCATION_SCOPE("Ship::getPossibleMoves");
+        std::vector<Position> moves;
+        for (int dx = -moveRange; dx <= moveRange; ++dx) {
+            for (int dy = -moveRange; dy <= moveRange; ++dy) {
+                if (std::abs(dx) + std::abs(dy) <= moveRange) {
+                    Position newPos(position.x + dx, position.y + dy);
+                    if (isValidPosition(newPos)) {
+                        moves.push_back(newPos);
+                    }
+                }
+            }
+        }
+        COUNT_WORK(reachableCells, moves.size());
+        return moves;
+    }
+
+private:
+    int maxHealth;
+    int health;
+    int moveRange;
+    int remainingCrossMissiles;
+    int remainingSquareMissiles;
+    Position position;
+    std::vector<Position> cachedMoves;
+    int mapSize;
+
+    bool isValidPosition(const Position& pos) const {
+        return pos.x >= 0 && pos.x < mapSize && pos.y >= 0 && pos.y < mapSize;
+    }
+};
+
+
+class Player {
+public:
+    Player(bool isFirst, const StrategyParams& customParams = StrategyParams(true),
+           const GameConfig& config = GameConfig())
+        : isFirstPlayer(isFirst), params(customParams), config(config) {
+        initializeShips(isFirst);
+    }
+
+    void placeShips(std::mt19937& gen) {
+        for (size_t i = 0; i < ships.size(); ++i) {
+            bool placed = false;
+            while (!placed) {
+                int x = isFirstPlayer ?
+                    (gen() % (config.mapSize / 3)) :
+                    (config.mapSize - 1 - (gen() % (config.mapSize / 3)));
+                int y = gen() % config.mapSize;
+
+                Position pos(x, y);
+                if (canPlaceShip(pos)) {
+                    ships[i].setPosition(pos);
+                    placed = true;
+                }
+            }
+        }
+    }
+
+    struct MoveDecision {
+        Position position;
+        double score;
+        std::string explanation;
+    };
+
+    MoveDecision chooseMovePosition(Ship& ship, const Player& enemy) {
+        ALLOCATION_SCOPE("Player::chooseMovePosition");
+        std::vector<Position> moves = ship.getPossibleMoves();
+        MoveDecision best{ship.getPosition(),
+                         -std::numeric_limits<double>::infinity(),
+                         "No valid moves"};
+
+        for (const Position& move : moves) {
+            if (!canMoveTo(move)) continue;
+
+            std::string explanation;
+            double score = evaluateMove(move, ship, enemy, explanation);
+
+            if (score > best.score ) {
+                best = {move, score, explanation};
+            }
+        }
+
+        return best;
+    }
+
+    struct AttackDecision {
+        Position position;
+        Missile::Type missileType;
+        double score;
+        std::string explanation;
+        std::vector<Position> potentialTargets;
+    };
+
+    AttackDecision chooseAttackPosition(Ship& ship, const Player& enemy) {
+    ALLOCATION_SCOPE("Player::chooseAttackPosition");
+    AttackDecision best{{-1, -1}, Missile::CROSS,
+                       -std::numeric_limits<double>::infinity(),
+                       "No valid attacks"};
+
+    if (ship.getCrossMissiles() > 0 || ship.getSquareMissiles() > 0) {
+
+        std::vector<std::pair<Position, double>> allEnemyPositions;
+        for (const Ship& enemyShip : enemy.getShips()) {
+            if (enemyShip.isDead()) continue;
+
+            std::vector<Position> possibleMoves =
+                const_cast<Ship&>(enemyShip).getPossibleMoves();
+            double valuePerPosition = enemyShip.getValue(enemy.getParams()) /
+                                    possibleMoves.size();
+
+            for (const Position& pos : possibleMoves) {
+                allEnemyPositions.emplace_back(pos, valuePerPosition);
+            }
+        }
+
+        // evaluate all potential attack position
+        for (const auto& [target, baseValue] : allEnemyPositions) {
+            COUNT_WORK(targetsEvaluated, 1);
+            Ray ray(ship.getPosition(), target);
+            bool pathBlocked = false;
+            std::vector<Position> targetsOnRay;
+            double totalScore = 0;
+
+            // check the potential for each attack choice
+            for (const auto& [enemyPos, enemyValue] : allEnemyPositions) {
+                auto [distance, t] = ray.distanceAndProjection(enemyPos);
+                if (t > EPSILON && distance < EPSILON) {
+                    targetsOnRay.push_back(enemyPos);
+                    totalScore += enemyValue;
+                }
+            }
+
+            // check if the path is blocked by allies
+            for (const Ship& allyShip : ships) {
+                if (!allyShip.isDead() && &allyShip != &ship) {
+                    auto [distance, t] = ray.distanceAndProjection(
+                        allyShip.getPosition());
+                    if (t > EPSILON && t < 1.0 && distance < EPSILON) {
+                        pathBlocked = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!pathBlocked && !targetsOnRay.empty()) {
+                for (int type = 0; type <= 1; ++type) {
+                    Missile::Type missileType =
+                        type == 0 ? Missile::CROSS : Missile::SQUARE;
+
+                    if ((missileType == Missile::CROSS &&
+                         ship.getCrossMissiles() == 0) ||
+                        (missileType == Missile::SQUARE &&
+                         ship.getSquareMissiles() == 0)) {
+                        continue;
+                    }
+
+                    std::string explanation;
+                    double score = evaluateAttack(target, enemy,
+                                                missileType, explanation);
+                    score += totalScore;
+
+                    if (score > best.score && score>params.attackThreshold) {
+                        best = {target, missileType, score, explanation,
+                              targetsOnRay};
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+
+    const std::vector<Ship>& getShips() const { return ships; }
+    bool isDefeated() const {
+        return std::all_of(ships.begin(), ships.end(),
+                          [](const Ship& s) { return s.isDead(); });
+    }
+
+    const StrategyParams& getParams() const { return params; }
+    void setParams(const StrategyParams& newParams) { params = newParams; }
+
+    // a fresh, unplaced fleet; keeps the ship storage
+    void reset(const StrategyParams& newParams) {
+        params = newParams;
+        ships.clear();
+        initializeShips(isFirstPlayer);
+    }
+
+private:
+    bool isFirstPlayer;
+    std::vector<Ship> ships;
+    StrategyParams params;
+    GameConfig config;
+
+
+    void initializeShips(bool isFirst) {
+        int scale = config.fleetScale;
+        int bonus = config.moveRangeBonus;
+        int size = config.mapSize;
+        if(isFirst) {
+            for(int i=0; i<2 * scale; i++) {
+                ships.push_back(Ship(1, 2 + bonus, 0, 3, size));
+            }
+            for (int i=0; i<2 * scale; i++) {
+                ships.push_back(Ship(2, 3 + bonus, 4, 2, size));
+            }
+            for (int i=0; i<4 * scale; i++) {
+                ships.push_back(Ship(3, 4 + bonus, 5, 4, size));
+            }
+        } else {
+            for(int i=0; i<3 * scale; i++) {
+                ships.push_back(Ship(1, 2 + bonus, 0, 3, size));
+            }
+            for (int i=0; i<3 * scale; i++) {
+                ships.push_back(Ship(2, 3 + bonus, 4, 2, size));
+            }
+            for (int i=0; i<3 * scale; i++) {
+                ships.push_back(Ship(3, 4 + bonus, 5, 4, size));
+            }
+        }
+    }
+
+    bool canPlaceShip(const Position& pos) const {
+        for (const Ship& ship : ships) {
+            if (!ship.isDead() &&
+                ship.getPosition().distanceTo(pos) < 2) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool canMoveTo(const Position& pos) const {
+        return pos.x >= 0 && pos.x < config.mapSize &&
+               pos.y >= 0 && pos.y < config.mapSize &&
+               canPlaceShip(pos);
+    }
+
+public:
+    // the scoring kernels behind chooseMovePosition and chooseAttackPosition,
+    // public so that the benchmark suite can time them on their own
+    double evaluateMove(const Position& move, const Ship& ship,
+                   const Player& enemy, std::string& explanation) {
+    ALLOCATION_SCOPE("Player::evaluateMove");
+    COUNT_WORK(movesScored, 1);
+    double score = 0;
+    explanation = "";
+
+
+    double enemyDistanceScore = 0;
+    for (const Ship& enemyShip : enemy.getShips()) {
+        if (!enemyShip.isDead()) {
+            double dist = move.distanceTo(enemyShip.getPosition());
+            enemyDistanceScore += params.enemyDistanceWeight / dist;
+        }
+    }
+    score += enemyDistanceScore;
+    //std::cout<<"score after calculating enemy distance score: "<<score<<std::endl;
+
+    double allyDistanceScore = 0;
+    for (const Ship& allyShip : ships) {
+        if (!allyShip.isDead() && &allyShip != &ship) {
+            double dist = move.distanceTo(allyShip.getPosition());
+            allyDistanceScore += params.allyDistanceWeight / dist;
+        }
+    }
+    score += allyDistanceScore;
+    //std::cout<<"score after calculating ally distance score: "<<score<<std::endl;
+
+    int blockCount = 0, targetCount = 0;
+    for (const Ship& enemyShip : enemy.getShips()) {
+        if (!enemyShip.isDead()) {
+            for (const Ship& allyShip : ships) {
+                if (!allyShip.isDead() && &allyShip != &ship) {
+                    Ray ray(enemyShip.getPosition(), allyShip.getPosition());
+                    auto [distance, t] = ray.distanceAndProjection(move);
+                    if (distance < EPSILON && t > EPSILON && t < 1.0) {
+                        ++blockCount;
+                    }
+                }
+            }
+
+            // check whether others block enemy ship
+            Ray ray(enemyShip.getPosition(), move);
+            bool isTarget = true;
+            auto [distance, t] = ray.distanceAndProjection(move);
+            if (distance < EPSILON && t > EPSILON) {
+                // enemy blocks
+                for (const Ship& otherShip : enemy.getShips()) {
+                    if (!otherShip.isDead() && &otherShip != &enemyShip) {
+                        auto [blockDist, blockT] =
+                            ray.distanceAndProjection(otherShip.getPosition());
+                        if (blockDist < EPSILON && blockT > EPSILON && blockT < t) {
+                            isTarget = false;
+                            break;
+                        }
+                    }
+                }
+
+                // allies block
+                if (isTarget) {
+                    for (const Ship& allyShip : ships) {
+                        if (!allyShip.isDead() && &allyShip != &ship) {
+                            auto [blockDist, blockT] =
+                                ray.distanceAndProjection(allyShip.getPosition());
+                            if (blockDist < EPSILON && blockT > EPSILON && blockT < t) {
+                                isTarget = false;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if (isTarget) ++targetCount;
+            }
+        }
+    }
+
+    score += blockCount * params.blockWeight * ship.getValue(params);
+    score += targetCount * params.targetWeight * ship.getValue(params);
+    //std::cout<<"score after calculating block and target score: "<<score<<std::endl;
+    return score;
+}
+
+    double evaluateAttack(const Position& target, const Player& enemy,
+                         Missile::Type missileType, std::string& explanation) {
+        ALLOCATION_SCOPE("Player::evaluateAttack");
+        double score = 0;
+        explanation = "";
+
+        Missile missile(missileType, config.mapSize);
+        std::vector<Position> damageArea = missile.getDamageArea(target);
+
+        double potentialDamage = 0;
+        for (const Ship& enemyShip : enemy.getShips()) {
+            if (!enemyShip.isDead()) {
+                std::vector<Position> moves =
+                    const_cast<Ship&>(enemyShip).getPossibleMoves();
+                double moveCount = moves.size();
+
+                for (const Position& pos : damageArea) {
+                    for (const Position& move : moves) {
+                        if (pos == move) {
+                            potentialDamage += enemyShip.getValue(enemy.getParams()) /
+                                             moveCount;
+                        }
+                    }
+                }
+            }
+        }
+
+        score += potentialDamage;
+
+        // check if the attack is possibly blocked by allies
+        for (const Ship& allyShip : ships) {
+            if (!allyShip.isDead()) {
+                for (const Position& pos : damageArea) {
+                    if (pos == allyShip.getPosition()) {
+                        return -std::numeric_limits<double>::infinity();
+                    }
+                }
+            }
+        }
+
+        return score;
+    }
+};
+
+// splitmix64 finalizer, used to derive independent per-game seeds from a base seed
+inline uint64_t mixSeed(uint64_t base, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0) {
+    uint64_t z = base;
+    for (uint64_t v : {a, b, c}) {
+        z += 0x9E3779B97F4A7C15ULL + v;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+    }
+    return z;
+}
+
+inline uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+// Phases of a round, in the order Game::run plays them.
+enum class GamePhase {
+    PLACEMENT,
+    P1_ATTACK_CHOICE,
+    P2_MOVE,
+    P1_RESOLVE,
+    P2_ATTACK_CHOICE,
+    P1_MOVE,
+    P2_RESOLVE
+};
+
+inline const char* const PHASE_NAMES[] = {
+    "placement", "P1 attack choice", "P2 move", "P1 resolve",
+    "P2 attack choice", "P1 move", "P2 resolve"
+};
+
+// the round phases, P1_ATTACK_CHOICE to P2_RESOLVE, timed in GameResult::phaseSeconds
+const int TIMED_PHASE_COUNT = 6;
+
+// Clock of the phase timers: the x86 time-stamp counter when built with
+// TBS_RDTSC_TIMERS, steady_clock nanoseconds otherwise.
+struct PhaseClock {
+    static uint64_t now() {
+#ifdef TBS_RDTSC_TIMERS
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static double secondsPerTick() {
+#ifdef TBS_RDTSC_TIMERS
+        // calibrated once against steady_clock
+        static const double value = []() {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t startTicks = __rdtsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            uint64_t ticks = __rdtsc() - startTicks;
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+                   static_cast<double>(ticks);
+        }();
+        return value;
+#else
+        return 1e-9;
+#endif
+    }
+};
+
+// Chrome/Perfetto trace-event recorder, enabled with --trace FILE. Every
+// thread records into its own fixed ring without locks or allocation (events
+// are dropped, and counted, when a ring is full); a background thread drains
+// the rings into the JSON file, so recording stays off the measured path.
+// Events land on one track per worker: the calling thread is worker 0 and
+// GameExecutor helpers take their worker index.
+class Tracer {
+public:
+    struct Event {
+        const char* name;             // string literals only, written at flush time
+        const char* argNames[2];
+        int64_t args[2];
+        uint64_t start;               // ns since the tracer started
+        uint64_t duration;
+        uint32_t track;
+        char type;                    // 'X' complete span, 'B'/'E' begin/end, 'C' counter
+        uint8_t argCount;
+    };
+
+    explicit Tracer(const std::string& path)
+        : out(path, std::ios::trunc), origin(std::chrono::steady_clock::now()) {
+        if (!out) throw std::runtime_error("cannot open trace file " + path);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        active = this;
+        threadTrack = 0;
+        nameThread(0, "worker 0");
+        flusher = std::thread([this]() { flushLoop(); });
+    }
+
+    ~Tracer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        active = nullptr;
+
+        drain();
+        for (const auto& [track, name] : trackNames) {
+            separate();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track
+                << ",\"args\":{\"name\":\"" << name << "\"}}";
+        }
+        out << "\n]}\n";
+        if (dropped > 0) {
+            std::cerr << "Trace dropped " << dropped << " events (ring full)\n";
+        }
+    }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static bool enabled() { return active != nullptr; }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - active->origin).count());
+    }
+
+    // puts the calling thread's events on the given worker track
+    static void setWorker(int worker) {
+        if (!active) return;
+        threadTrack = worker;
+        active->nameThread(worker, "worker " + std::to_string(worker));
+    }
+
+    static void complete(const char* name, uint64_t start, const char* argName = nullptr,
+                         int64_t arg = 0) {
+        Event event{name, {argName, nullptr}, {arg, 0}, start, now() - start, 0, 'X',
+                    static_cast<uint8_t>(argName ? 1 : 0)};
+        record(event);
+    }
+
+    static void begin(const char* name, const char* argName, int64_t arg) {
+        record(Event{name, {argName, nullptr}, {arg, 0}, now(), 0, 0, 'B', 1});
+    }
+
+    static void end(const char* name) {
+        record(Event{name, {nullptr, nullptr}, {0, 0}, now(), 0, 0, 'E', 0});
+    }
+
+    static void counter(const char* name, const char* firstName, int64_t first,
+                        const char* secondName, int64_t second) {
+        record(Event{name, {firstName, secondName}, {first, second}, now(), 0, 0, 'C', 2});
+    }
+
+private:
+    static constexpr size_t RING_SIZE = 1 << 14;
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(20);
+
+    // single producer (the owning thread), single consumer (the flusher)
+    struct Ring {
+        std::array<Event, RING_SIZE> events;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+    };
+
+    // hands a thread's ring back to the tracer when the thread exits
+    struct Lease {
+        Ring* ring = nullptr;
+        ~Lease() {
+            if (ring && active) active->release(ring);
+        }
+    };
+
+    static inline Tracer* active = nullptr;
+    static thread_local Lease lease;
+    static inline thread_local int threadTrack = -1;
+
+    std::ofstream out;
+    std::chrono::steady_clock::time_point origin;
+    std::thread flusher;
+    std::mutex mutex;                       // guards everything below and the file
+    std::condition_variable wake;
+    bool stopping = false;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> freeRings;
+    std::map<int, std::string> trackNames;
+    int nextTrack = 64;                     // for threads that are not workers
+    bool firstEvent = true;
+    std::atomic<uint64_t> dropped{0};
+
+    static void record(Event event) {
+        Tracer* tracer = active;
+        if (!tracer) return;
+        if (!lease.ring) lease.ring = tracer->acquire();
+        if (threadTrack < 0) {
+            std::lock_guard<std::mutex> lock(tracer->mutex);
+            threadTrack = tracer->nextTrack++;
+            tracer->trackNames[threadTrack] = "thread " + std::to_string(threadTrack);
+        }
+        event.track = static_cast<uint32_t>(threadTrack);
+
+        Ring& ring = *lease.ring;
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) == RING_SIZE) {
+            tracer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring.events[head % RING_SIZE] = event;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    void nameThread(int track, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        trackNames[track] = name;
+    }
+
+    Ring* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeRings.empty()) {
+            Ring* ring = freeRings.back();
+            freeRings.pop_back();
+            return ring;
+        }
+        rings.push_back(std::make_unique<Ring>());
+        return rings.back().get();
+    }
+
+    void release(Ring* ring) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeRings.push_back(ring);
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, FLUSH_INTERVAL);
+            drainLocked();
+        }
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> lock(mutex);
+        drainLocked();
+    }
+
+    void drainLocked() {
+        for (const std::unique_ptr<Ring>& ring : rings) {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail < head; ++tail) write(ring->events[tail % RING_SIZE]);
+            ring->tail.store(tail, std::memory_order_release);
+        }
+        out.flush();
+    }
+
+    void separate() {
+        if (!firstEvent) out << ",\n";
+        firstEvent = false;
+    }
+
+    void write(const Event& event) {
+        separate();
+        out << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.type
+            << "\",\"pid\":1,\"tid\":" << event.track << ",\"ts\":" << event.start / 1000
+            << '.' << std::setw(3) << std::setfill('0') << event.start % 1000 << std::setfill(' ');
+        if (event.type == 'X') {
+            out << ",\"dur\":" << event.duration / 1000 << '.' << std::setw(3)
+                << std::setfill('0') << event.duration % 1000 << std::setfill(' ');
+        }
+        if (event.argCount > 0) {
+            out << ",\"args\":{";
+            for (int a = 0; a < event.argCount; ++a) {
+                out << (a ? "," : "") << '"' << event.argNames[a] << "\":" << event.args[a];
+            }
+            out << '}';
+        }
+        out << '}';
+    }
+};
+
+struct GameResult {
+    int rounds;
+    int p1Ships;
+    int p1Health;
+    int p2Ships;
+    int p2Health;
+    int winner; // 1 for player1, 2 for player2, 0 for draw
+    double duration; // in seconds
+    // time spent in each round phase, indexed by GamePhase - 1
+    std::array<double, TIMED_PHASE_COUNT> phaseSeconds{};
+#ifdef TBS_WORK_COUNTERS
+    // work done in each player's phases, indexed by player - 1
+    std::array<WorkCounters, 2> work{};
+    // heap allocations of each round phase, indexed by GamePhase - 1
+    std::array<AllocationCounts, TIMED_PHASE_COUNT> phaseAllocations{};
+#endif
+};
+
+// Compile-time observer of a game: BasicGame<Observer> calls these hooks as it
+// plays. Players are numbered 1 and 2, ships by their index in the player's
+// fleet. Observers derive from NoObserver and hide the hooks they need; the
+// calls are resolved statically, and a game observed by NoObserver itself (the
+// plain Game) compiles them away entirely.
+struct NoObserver {
+    void onPlacement(int /*player*/, int /*ship*/, const Position& /*pos*/) {}
+    void onRoundStart(int /*round*/) {}
+    // every attack decision of a ship, including the ones scored too low to fire
+    void onAttackEvaluated(int /*player*/, int /*ship*/, const Position& /*from*/,
+                           const Position& /*target*/, Missile::Type /*type*/, double /*score*/) {}
+    void onAttackChosen(int /*player*/, int /*ship*/, const Position& /*target*/,
+                        Missile::Type /*type*/) {}
+    void onMoveEvaluated(int /*player*/, int /*ship*/, const Position& /*from*/,
+                         const Position& /*to*/, double /*score*/) {}
+    void onMove(int /*player*/, int /*ship*/, const Position& /*to*/) {}
+    void onAttackTriggered(int /*player*/, int /*ship*/) {}
+    void onHit(int /*player*/, int /*ship*/, int /*damage*/) {}
+    void onPhaseEnd(int /*round*/, GamePhase /*phase*/) {}
+    void onRoundEnd(int /*round*/) {}
+    void onGameEnd(const GameResult& /*result*/) {}
+};
+
+template <typename Observer = NoObserver>
+class BasicGame {
+public:
+    using GameResult = tbs::GameResult;
+
+    BasicGame() : BasicGame(StrategyParams(true), StrategyParams(false)) {}
+
+    BasicGame(const StrategyParams& p1Params, const StrategyParams& p2Params)
+        : BasicGame(p1Params, p2Params, randomSeed()) {}
+
+    // placements (the only random part of a game) are fully determined by the seed
+    BasicGame(const StrategyParams& p1Params, const StrategyParams& p2Params, uint64_t seed,
+              const GameConfig& config = GameConfig())
+        : player1(true, p1Params, config), player2(false, p2Params, config), round(0),
+          seed(seed), config(config) {
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        rng.seed(seq);
+    }
+
+    uint64_t getSeed() const { return seed; }
+
+    const Player& getPlayer(int id) const { return id == 1 ? player1 : player2; }
+
+    // the observer is not owned and must outlive run()
+    void setObserver(Observer* gameObserver) { observer = gameObserver; }
+
+    GameResult run() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        uint64_t traceStart = Tracer::enabled() ? Tracer::now() : 0;
+
+        start();
+        while (!isGameOver()) {
+            beginRound();
+            playPhase(GamePhase::P1_ATTACK_CHOICE);
+            playPhase(GamePhase::P2_MOVE);
+            playPhase(GamePhase::P1_RESOLVE);
+
+            if (isGameOver()) break;
+
+            playPhase(GamePhase::P2_ATTACK_CHOICE);
+            playPhase(GamePhase::P1_MOVE);
+            playPhase(GamePhase::P2_RESOLVE);
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double duration = std::chrono::duration<double>(endTime - startTime).count();
+        GameResult result = finish(duration);
+        if (Tracer::enabled()) Tracer::complete("game", traceStart, "rounds", round);
+        return result;
+    }
+
+    // The pieces of run(), for callers that step a game themselves (BatchedEnv):
+    // start(), then per round beginRound() and the phases in GamePhase order,
+    // skipping the second half when the game is over after P1_RESOLVE.
+
+    void start() {
+        player1.placeShips(rng);
+        notifyPlacements(player1, 1);
+        player2.placeShips(rng);
+        notifyPlacements(player2, 2);
+        endPhase(GamePhase::PLACEMENT);
+    }
+
+    void beginRound() {
+        ++round;
+        if (Tracer::enabled()) {
+            Tracer::begin("round", "round", round);
+            roundTraced = true;
+        }
+        roundOpen = true;
+        notify([&](Observer& o) { o.onRoundStart(round); });
+    }
+
+    void playPhase(GamePhase phase) {
+        uint64_t traceStart = Tracer::enabled() ? Tracer::now() : 0;
+#ifdef TBS_WORK_COUNTERS
+        // each round phase belongs to the player it names
+        bool firstPlayerPhase = phase == GamePhase::P1_ATTACK_CHOICE ||
+                                phase == GamePhase::P1_RESOLVE || phase == GamePhase::P1_MOVE;
+        WorkCounters& counters = workCounters[firstPlayerPhase ? 0 : 1];
+        activeWorkCounters = &counters;
+        AllocationCounts allocationsBefore = threadAllocationCounts();
+#endif
+        uint64_t start = PhaseClock::now();
+        switch (phase) {
+            case GamePhase::PLACEMENT: break;
+            case GamePhase::P1_ATTACK_CHOICE: chooseAttacks(player1, player2, 1); break;
+            case GamePhase::P2_MOVE: moveShips(player2, player1, 2); break;
+            case GamePhase::P1_RESOLVE: triggerAttacks(player1, player2, 1); break;
+            case GamePhase::P2_ATTACK_CHOICE: chooseAttacks(player2, player1, 2); break;
+            case GamePhase::P1_MOVE: moveShips(player1, player2, 1); break;
+            case GamePhase::P2_RESOLVE: triggerAttacks(player2, player1, 2); break;
+        }
+        if (phase != GamePhase::PLACEMENT) {
+            phaseTicks[static_cast<int>(phase) - 1] += PhaseClock::now() - start;
+        }
+#ifdef TBS_WORK_COUNTERS
+        AllocationCounts allocated = threadAllocationCounts() - allocationsBefore;
+        counters.allocations += allocated.allocations;
+        counters.allocatedBytes += allocated.bytes;
+        if (phase != GamePhase::PLACEMENT) {
+            phaseAllocations[static_cast<int>(phase) - 1] += allocated;
+        }
+        activeWorkCounters = nullptr;
+#endif
+        if (Tracer::enabled()) {
+            Tracer::complete(PHASE_NAMES[static_cast<int>(phase)], traceStart, "round", round);
+        }
+        endPhase(phase);
+        if (phase == GamePhase::P2_RESOLVE) endRound();
+    }
+
+    GameResult finish(double duration) {
+        // a game that ends after P1_RESOLVE leaves its last round open
+        if (roundOpen) endRound();
+        GameResult result = getGameResult(duration);
+        notify([&](Observer& o) { o.onGameEnd(result); });
+        return result;
+    }
+
+    bool isGameOver() const {
+        if (round >= config.maxRounds) return true;
+        if (player1.isDefeated() || player2.isDefeated()) return true;
+
+        bool player1HasMissiles = false;
+        bool player2HasMissiles = false;
+
+        for (const Ship& ship : player1.getShips()) {
+            if (!ship.isDead() &&
+                (ship.getCrossMissiles() > 0 ||
+                 ship.getSquareMissiles() > 0)) {
+                player1HasMissiles = true;
+                break;
+            }
+        }
+
+        for (const Ship& ship : player2.getShips()) {
+            if (!ship.isDead() &&
+                (ship.getCrossMissiles() > 0 ||
+                 ship.getSquareMissiles() > 0)) {
+                player2HasMissiles = true;
+                break;
+            }
+        }
+
+        return !player1HasMissiles && !player2HasMissiles;
+    }
+
+    int getRound() const { return round; }
+
+    // restarts the game with new parameters and seed, reusing its storage
+    void reset(const StrategyParams& p1Params, const StrategyParams& p2Params, uint64_t newSeed) {
+        player1.reset(p1Params);
+        player2.reset(p2Params);
+        round = 0;
+        roundOpen = false;
+        phaseTicks = {};
+        workCounters = {};
+        phaseAllocations = {};
+        seed = newSeed;
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        rng.seed(seq);
+    }
+
+    // takes effect from the player's next decision
+    void setParams(int id, const StrategyParams& params) {
+        (id == 1 ? player1 : player2).setParams(params);
+    }
+
+private:
+    Player player1, player2;
+    int round;
+    uint64_t seed;
+    std::mt19937 rng;
+    Observer* observer = nullptr;
+    GameConfig config;
+
+    // attacks chosen by each player, triggered after the other player's move
+    using PendingAttack = std::tuple<Position, Missile::Type, Ship*>;
+    std::vector<PendingAttack> pendingAttacks[2];
+
+    std::array<uint64_t, TIMED_PHASE_COUNT> phaseTicks{};
+    bool roundOpen = false;    // beginRound() without the round's end yet
+    bool roundTraced = false;  // a "round" trace span is open
+    std::array<WorkCounters, 2> workCounters{};
+    std::array<AllocationCounts, TIMED_PHASE_COUNT> phaseAllocations{};
+
+    static int shipIndex(const Player& player, const Ship& ship) {
+        return static_cast<int>(&ship - player.getShips().data());
+    }
+
+    // calls hook(observer) when there is one; compiles to nothing for NoObserver
+    template <typename Hook>
+    void notify(Hook hook) {
+        if constexpr (!std::is_same_v<Observer, NoObserver>) {
+            if (observer) hook(*observer);
+        }
+    }
+
+    void endPhase(GamePhase phase) {
+        notify([&](Observer& o) { o.onPhaseEnd(round, phase); });
+    }
+
+    void endRound() {
+        if (roundTraced) endRoundTrace();
+        roundOpen = false;
+        notify([&](Observer& o) { o.onRoundEnd(round); });
+    }
+
+    void notifyPlacements(const Player& player, int id) {
+        notify([&](Observer& o) {
+            for (const Ship& ship : player.getShips()) {
+                o.onPlacement(id, shipIndex(player, ship), ship.getPosition());
+            }
+        });
+    }
+
+    // closes the round's trace span, with the fleets' state as counters
+    void endRoundTrace() {
+        int ships[2] = {}, missiles[2] = {};
+        for (int p = 0; p < 2; ++p) {
+            for (const Ship& ship : (p == 0 ? player1 : player2).getShips()) {
+                if (ship.isDead()) continue;
+                ++ships[p];
+                missiles[p] += ship.getCrossMissiles() + ship.getSquareMissiles();
+            }
+        }
+        Tracer::counter("alive ships", "P1", ships[0], "P2", ships[1]);
+        Tracer::counter("missiles", "P1", missiles[0], "P2", missiles[1]);
+        Tracer::end("round");
+        roundTraced = false;
+    }
+
+    void chooseAttacks(Player& attacker, const Player& defender, int id) {
+        std::vector<PendingAttack>& attacks = pendingAttacks[id - 1];
+        attacks.clear();
+        for (Ship& ship : const_cast<std::vector<Ship>&>(attacker.getShips())) {
+            if (!ship.isDead()) {
+                uint64_t traceStart = Tracer::enabled() ? Tracer::now() : 0;
+                auto decision = attacker.chooseAttackPosition(ship, defender);
+                if (Tracer::enabled()) {
+                    Tracer::complete("attack decision", traceStart, "ship", shipIndex(attacker, ship));
+                }
+                notify([&](Observer& o) {
+                    o.onAttackEvaluated(id, shipIndex(attacker, ship), ship.getPosition(),
+                                        decision.position, decision.missileType, decision.score);
+                });
+                if (decision.score > 0) {
+                    attacks.emplace_back(decision.position, decision.missileType, &ship);
+                    COUNT_WORK(attacksIssued, 1);
+                    notify([&](Observer& o) {
+                        o.onAttackChosen(id, shipIndex(attacker, ship), decision.position,
+                                         decision.missileType);
+                    });
+                }
+            }
+        }
+    }
+
+    void moveShips(Player& mover, const Player& enemy, int id) {
+        for (Ship& ship : const_cast<std::vector<Ship>&>(mover.getShips())) {
+            if (!ship.isDead()) {
+                uint64_t traceStart = Tracer::enabled() ? Tracer::now() : 0;
+                auto decision = mover.chooseMovePosition(ship, enemy);
+                if (Tracer::enabled()) {
+                    Tracer::complete("move decision", traceStart, "ship", shipIndex(mover, ship));
+                }
+                notify([&](Observer& o) {
+                    int index = shipIndex(mover, ship);
+                    o.onMoveEvaluated(id, index, ship.getPosition(), decision.position, decision.score);
+                    o.onMove(id, index, decision.position);
+                });
+                ship.setPosition(decision.position);
+            }
+        }
+    }
+
+    void triggerAttacks(Player& attacker, Player& defender, int id) {
+        for (const auto& [pos, type, ship] : pendingAttacks[id - 1]) {
+            if (ship->useMissile(type)) {
+                COUNT_WORK(attacksTriggered, 1);
+                notify([&](Observer& o) { o.onAttackTriggered(id, shipIndex(attacker, *ship)); });
+                handleAttack(pos, type, defender);
+            }
+        }
+    }
+
+    void handleAttack(const Position& target, Missile::Type missileType, Player& defender) {
+        Missile missile(missileType, config.mapSize);
+        std::vector<Position> damageArea = missile.getDamageArea(target);
+
+        for (const Position& pos : damageArea) {
+            for (Ship& ship : const_cast<std::vector<Ship>&>(defender.getShips())) {
+                if (!ship.isDead() && ship.getPosition() == pos) {
+                    ship.takeDamage(1);
+                    notify([&](Observer& o) {
+                        o.onHit(&defender == &player1 ? 1 : 2, shipIndex(defender, ship), 1);
+                    });
+                }
+            }
+        }
+    }
+
+    GameResult getGameResult(double duration) const {
+        int p1Ships = 0, p1Health = 0;
+        int p2Ships = 0, p2Health = 0;
+        int p1shipDestroyed=0;
+        int p2shipDestroyed=0;
+
+        for (const Ship& ship : player1.getShips()) {
+            if (!ship.isDead()) {
+                ++p1Ships;
+                p1Health += ship.getHealth();
+            }
+            else {
+                p1shipDestroyed++;
+            }
+        }
+
+        for (const Ship& ship : player2.getShips()) {
+            if (!ship.isDead()) {
+                ++p2Ships;
+                p2Health += ship.getHealth();
+            }
+            else {
+                p2shipDestroyed++;
+            }
+        }
+
+        int winner;
+        if (p1shipDestroyed < p2shipDestroyed || (p1shipDestroyed == p2shipDestroyed && p1Health > p2Health)) {
+            winner = 1;
+        } else if (p2shipDestroyed < p1shipDestroyed || (p1shipDestroyed == p2shipDestroyed && p2Health > p1Health)) {
+            winner = 2;
+        } else {
+            winner = 0;
+        }
+
+        GameResult result{round, p1Ships, p1Health, p2Ships, p2Health,
+                          winner, duration};
+        for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+            result.phaseSeconds[phase] = phaseTicks[phase] * PhaseClock::secondsPerTick();
+        }
+#ifdef TBS_WORK_COUNTERS
+        result.work = workCounters;
+        result.phaseAllocations = phaseAllocations;
+#endif
+        return result;
+    }
+};
+
+using Game = BasicGame<>;
+
+// Prints a game as it is played: placements, every decision and hit, and both
+// fleets after each move and resolve phase. `--watch` attaches it. With
+// VERBOSE_OUTPUT it also prints how each ship's decisions scored.
+class ConsoleObserver : public NoObserver {
+public:
+    template <typename G>
+    explicit ConsoleObserver(const G& game) : players{&game.getPlayer(1), &game.getPlayer(2)} {}
+
+    void onAttackEvaluated(int player, int ship, const Position& from, const Position& target,
+                           Missile::Type type, double score) {
+        if (!VERBOSE_OUTPUT) return;
+        std::cout << "Player " << player << " evaluated attacks for ship " << ship + 1 << " at ("
+                  << from.x << "," << from.y << "): ";
+        if (target.x < 0) {
+            std::cout << "no valid attack\n";
+        } else {
+            std::cout << "best (" << target.x << "," << target.y << ") with a "
+                      << (type == Missile::CROSS ? "CROSS" : "SQUARE") << " missile, score "
+                      << score << "\n";
+        }
+    }
+
+    void onPlacement(int player, int ship, const Position& pos) {
+        if (ship == 0) std::cout << "Player " << player << " placing ships:\n";
+        std::cout << "Ship " << ship + 1 << " placed at (" << pos.x << "," << pos.y << ")\n";
+    }
+
+    void onRoundStart(int round) { std::cout << "\nRound " << round << " Start!\n\n"; }
+
+    void onAttackChosen(int player, int ship, const Position& target, Missile::Type type) {
+        std::cout << "Player " << player << " ship " << ship + 1 << " aims at (" << target.x << ","
+                  << target.y << ") with a " << (type == Missile::CROSS ? "CROSS" : "SQUARE")
+                  << " missile\n";
+    }
+
+    void onMoveEvaluated(int player, int ship, const Position& from, const Position& to,
+                         double score) {
+        if (!VERBOSE_OUTPUT) return;
+        std::cout << "Player " << player << " evaluated moves for ship " << ship + 1 << " at ("
+                  << from.x << "," << from.y << "): best (" << to.x << "," << to.y
+                  << ") with score " << score << "\n";
+    }
+
+    void onMove(int player, int ship, const Position& to) {
+        std::cout << "Player " << player << " ship " << ship + 1 << " moves to (" << to.x << ","
+                  << to.y << ")\n";
+    }
+
+    void onAttackTriggered(int player, int ship) {
+        std::cout << "Player " << player << " ship " << ship + 1 << " fires\n";
+    }
+
+    void onHit(int player, int ship, int damage) {
+        std::cout << "Hit player " << player << " ship " << ship + 1 << ", damage dealt: "
+                  << damage << "\n";
+    }
+
+    void onPhaseEnd(int round, GamePhase phase) {
+        if (phase == GamePhase::P1_ATTACK_CHOICE || phase == GamePhase::P2_ATTACK_CHOICE) return;
+        std::cout << "\nGame state after " << PHASE_NAMES[static_cast<int>(phase)]
+                  << " (round " << round << "):\n";
+        printFleet(*players[0], "Player 1");
+        printFleet(*players[1], "Player 2");
+        std::cout << "\n";
+    }
+
+    void onGameEnd(const GameResult& result) {
+        std::cout << "\nGame Over!\n"
+                  << "Total Rounds: " << result.rounds << "\n\n"
+                  << "Player 1: " << result.p1Ships << " ships remaining, total HP: "
+                  << result.p1Health << "\n"
+                  << "Player 2: " << result.p2Ships << " ships remaining, total HP: "
+                  << result.p2Health << "\n\n";
+        if (result.winner == 0) {
+            std::cout << "It's a Draw!\n";
+        } else {
+            std::cout << "Player " << result.winner << " Wins!\n";
+        }
+    }
+
+private:
+    const Player* players[2];
+
+    static void printFleet(const Player& player, const std::string& name) {
+        std::cout << name << " ships status:\n";
+        int shipNum = 1;
+        for (const Ship& ship : player.getShips()) {
+            std::cout << "Ship " << shipNum++ << ": ";
+            if (ship.isDead()) {
+                std::cout << "Destroyed\n";
+            } else {
+                Position pos = ship.getPosition();
+                std::cout << "HP=" << ship.getHealth()
+                          << ", Cross Missiles=" << ship.getCrossMissiles()
+                          << ", Square Missiles=" << ship.getSquareMissiles()
+                          << ", Position=(" << pos.x << "," << pos.y << ")\n";
+            }
+        }
+    }
+};
+
+// the StrategyParams fields in declaration order, as the optimizers see them
+inline std::vector<double> paramsToVector(const StrategyParams& params) {
+    return {params.healthWeight, params.missileWeight, params.blockWeight,
+            params.targetWeight, params.enemyDistanceWeight,
+            params.allyDistanceWeight, params.attackThreshold};
+}
+
+inline StrategyParams paramsFromVector(const std::vector<double>& v) {
+    return StrategyParams(v[0], v[1], v[2], v[3], v[4], v[5], v[6]);
+}
+
+// how QAgent perturbs its best parameters when exploring
+enum class ExplorationMode { UNIFORM, SOBOL };
+
+// options shared by the tournament and training runners
+struct RunOptions {
+    std::string resultsPath;
+    uint64_t seed = randomSeed();
+    std::string checkpointPath;   // empty disables checkpointing
+    int checkpointInterval = 20;  // games (tournament) or episodes (training)
+    bool resume = false;
+    int shardIndex = 0;           // this process plays the tournament games
+    int shardCount = 1;           // whose number % shardCount == shardIndex
+    std::string replayDir;        // if set, every game's replay log is saved here
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int population = 1;           // training candidates per agent and generation
+    int gamesPerCandidate = 1;    // training games averaged into each candidate's reward
+    std::string optimizer = "qagent"; // training optimizer: qagent or cmaes
+    bool paired = false;          // evaluate on common random numbers (shared placement seeds)
+    bool racing = false;          // with --train, successive-halving races per generation
+    bool asyncActors = false;     // with --train, actor threads feed a learner thread
+    bool surrogate = false;       // with --train, screen explored candidates with a reward model
+    std::vector<std::string> surrogatePaths; // results files the reward model is warmed up from
+    bool league = false;          // with --train, evaluate candidates against an opponent pool
+    ExplorationMode exploration = ExplorationMode::UNIFORM; // QAgent perturbations
+
+    // optimizer comparison
+    std::string opponent = "Balanced";
+    int budget = 540;             // training games per optimizer
+    double targetWinRate = 0.8;
+    int evalGames = 20;
+
+    // scalability sweep
+    std::vector<int> sweepMapSizes = {64, 128, 256};
+    std::vector<int> sweepFleetScales = {1, 2};
+    std::vector<int> sweepRangeBonuses = {0, 1, 2};
+    int sweepRounds = 10;         // rounds per sweep game
+    int sweepGames = 4;           // games per sweep point
+
+    bool shouldResume() const {
+        return resume && !checkpointPath.empty() && std::filesystem::exists(checkpointPath);
+    }
+};
+
+// Plays one seeded game, saving its replay log when the options ask for it.
+// The log is named `replayName`.tbrp; by default the name combines the seed
+// with a hash of both parameter sets, so games replaying the same placements
+// (paired evaluation, swapped sides) keep separate logs.
+Game::GameResult playGame(const StrategyParams& p1Params, const StrategyParams& p2Params,
+                          uint64_t seed, const RunOptions& options,
+                          const GameConfig& config = GameConfig(),
+                          const std::string& replayName = std::string());
+
+struct GameJob {
+    StrategyParams p1Params;
+    StrategyParams p2Params;
+    uint64_t seed;
+    GameConfig config = GameConfig();
+    std::string replayName = std::string();  // see playGame
+};
+
+// Plays batches of independent games on options.threads threads. The calling
+// thread works on the batch too, so a single thread runs everything inline.
+class GameExecutor {
+public:
+    explicit GameExecutor(const RunOptions& options) : options(options) {}
+
+    int getThreadCount() const { return options.threads; }
+
+    // results are returned in job order whatever order the games finish in
+    std::vector<Game::GameResult> run(const std::vector<GameJob>& jobs) const {
+        std::vector<Game::GameResult> results(jobs.size());
+        std::atomic<size_t> nextJob{0};
+
+        auto worker = [&]() {
+            for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+                results[i] = playGame(jobs[i].p1Params, jobs[i].p2Params, jobs[i].seed,
+                                      options, jobs[i].config, jobs[i].replayName);
+            }
+        };
+
+        size_t helperCount = std::min<size_t>(options.threads, jobs.size());
+        std::vector<std::thread> helpers;
+        for (size_t t = 1; t < helperCount; ++t) {
+            helpers.emplace_back([&worker, t]() {
+                Tracer::setWorker(static_cast<int>(t));
+                worker();
+            });
+        }
+        worker();
+        for (std::thread& helper : helpers) helper.join();
+        return results;
+    }
+
+private:
+    const RunOptions& options;
+};
+
+// reward of one finished game from the given player's point of view
+double computeReward(const Game::GameResult& result, bool firstPlayer);
+
+// N independent games stepped in lockstep for learners that act inside a game
+// rather than once per game. Each step is one player 1 decision point: the
+// action (ACTION_SIZE doubles, the StrategyParams fields in declaration order)
+// becomes player 1's strategy for it, and the game advances until player 1's
+// next decision. Decision points alternate between attack choice (the round
+// start through P1_RESOLVE, plus P2_ATTACK_CHOICE) and move (P1_MOVE and
+// P2_RESOLVE). Player 2 always plays the fixed opponent strategy.
+//
+// Observations, rewards and done flags live in flat preallocated arrays
+// (env-major), and finished games restart in place, so stepping allocates
+// nothing outside the simulator's own decision code. Envs are spread over
+// persistent worker threads; the calling thread steps envs too.
+class BatchedEnv {
+public:
+    static constexpr int P1_SHIPS = 8;
+    static constexpr int P2_SHIPS = 9;
+    static constexpr int SHIP_FEATURES = 5;
+    // per ship x, y, health fraction, cross and square missiles; then the round
+    // fraction and 1 when the next decision is a move
+    static constexpr int OBS_SIZE = (P1_SHIPS + P2_SHIPS) * SHIP_FEATURES + 2;
+    static constexpr int ACTION_SIZE = 7;
+
+    BatchedEnv(size_t envCount, const StrategyParams& opponent, uint64_t baseSeed, int threads)
+        : opponent(opponent), baseSeed(baseSeed),
+          obs(envCount * OBS_SIZE), rewards(envCount), dones(envCount),
+          moveNext(envCount), episodes(envCount), lastResults(envCount) {
+        games.reserve(envCount);
+        for (size_t i = 0; i < envCount; ++i) {
+            games.emplace_back(StrategyParams(true), opponent, mixSeed(baseSeed, i));
+        }
+        for (int t = 1; t < threads && static_cast<size_t>(t) < envCount; ++t) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~BatchedEnv() {
+        stopping = true;
+        ++generation;
+        generation.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    BatchedEnv(const BatchedEnv&) = delete;
+    BatchedEnv& operator=(const BatchedEnv&) = delete;
+
+    size_t size() const { return games.size(); }
+
+    // restarts every env from episode 0
+    void reset() {
+        std::fill(episodes.begin(), episodes.end(), 0);
+        dispatch(Task::RESET, nullptr);
+    }
+
+    // actions holds size() * ACTION_SIZE values
+    void step(const double* actions) { dispatch(Task::STEP, actions); }
+
+    const float* observations() const { return obs.data(); }
+    const float* getRewards() const { return rewards.data(); }
+    const uint8_t* getDones() const { return dones.data(); }
+
+    // the result of the game env i finished in the last step that set its done flag
+    const Game::GameResult& getLastResult(size_t i) const { return lastResults[i]; }
+
+private:
+    enum class Task { RESET, STEP };
+
+    StrategyParams opponent;
+    uint64_t baseSeed;
+    std::vector<Game> games;
+    std::vector<float> obs;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<uint8_t> moveNext;
+    std::vector<uint64_t> episodes;
+    std::vector<Game::GameResult> lastResults;
+
+    std::vector<std::thread> workers;
+    std::atomic<uint64_t> generation{0};
+    std::atomic<size_t> nextEnv{0};
+    std::atomic<size_t> remaining{0};
+    std::atomic<bool> stopping{false};
+    Task task = Task::RESET;
+    const double* actions = nullptr;
+
+    void dispatch(Task newTask, const double* newActions) {
+        task = newTask;
+        actions = newActions;
+        remaining = games.size();
+        nextEnv = 0;
+        ++generation;
+        generation.notify_all();
+        work();
+        for (size_t left = remaining; left != 0; left = remaining) remaining.wait(left);
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            generation.wait(seen);
+            seen = generation;
+            if (stopping) return;
+            work();
+        }
+    }
+
+    void work() {
+        for (size_t i = nextEnv++; i < games.size(); i = nextEnv++) {
+            if (task == Task::RESET) restart(i);
+            else stepEnv(i);
+            if (--remaining == 0) remaining.notify_all();
+        }
+    }
+
+    void restart(size_t i) {
+        games[i].reset(StrategyParams(true), opponent, mixSeed(baseSeed, i, episodes[i]));
+        games[i].start();
+        moveNext[i] = 0;
+        observe(i);
+    }
+
+    static int totalHealth(const Player& player) {
+        int health = 0;
+        for (const Ship& ship : player.getShips()) health += ship.getHealth();
+        return health;
+    }
+
+    void stepEnv(size_t i) {
+        Game& game = games[i];
+        const double* a = actions + i * ACTION_SIZE;
+        game.setParams(1, StrategyParams(a[0], a[1], a[2], a[3], a[4], a[5], a[6]));
+
+        int ownBefore = totalHealth(game.getPlayer(1));
+        int enemyBefore = totalHealth(game.getPlayer(2));
+        if (!moveNext[i]) {
+            game.beginRound();
+            game.playPhase(GamePhase::P1_ATTACK_CHOICE);
+            game.playPhase(GamePhase::P2_MOVE);
+            game.playPhase(GamePhase::P1_RESOLVE);
+            if (!game.isGameOver()) {
+                game.playPhase(GamePhase::P2_ATTACK_CHOICE);
+                moveNext[i] = 1;
+            }
+        } else {
+            game.playPhase(GamePhase::P1_MOVE);
+            game.playPhase(GamePhase::P2_RESOLVE);
+            moveNext[i] = 0;
+        }
+
+        // damage dealt minus damage taken, plus the training reward at the end
+        float reward = static_cast<float>((enemyBefore - totalHealth(game.getPlayer(2))) -
+                                          (ownBefore - totalHealth(game.getPlayer(1))));
+        bool done = game.isGameOver();
+        if (done) {
+            lastResults[i] = game.finish(0.0);
+            reward += static_cast<float>(computeReward(lastResults[i], true));
+            ++episodes[i];
+            restart(i);
+        } else {
+            observe(i);
+        }
+        rewards[i] = reward;
+        dones[i] = done;
+    }
+
+    void observe(size_t i) {
+        float* out = obs.data() + i * OBS_SIZE;
+        auto ships = [&](const Player& player, int count) {
+            const std::vector<Ship>& fleet = player.getShips();
+            for (int s = 0; s < count; ++s) {
+                const Ship& ship = fleet[s];
+                *out++ = static_cast<float>(ship.getPosition().x) / MAP_SIZE;
+                *out++ = static_cast<float>(ship.getPosition().y) / MAP_SIZE;
+                *out++ = static_cast<float>(ship.getHealth()) / ship.getMaxHealth();
+                *out++ = static_cast<float>(ship.getCrossMissiles());
+                *out++ = static_cast<float>(ship.getSquareMissiles());
+            }
+        };
+        ships(games[i].getPlayer(1), P1_SHIPS);
+        ships(games[i].getPlayer(2), P2_SHIPS);
+        *out++ = static_cast<float>(games[i].getRound()) / MAX_ROUNDS;
+        *out++ = moveNext[i];
+    }
+};
+
+// ---- runners ----------------------------------------------------------------
+// The modes of the TurnBaseShipSimulator CLI. They print their progress and
+// reports to stdout and throw std::runtime_error on bad input.
+
+// the predefined strategy sets, by name
+std::vector<std::pair<std::string, StrategyParams>> getStrategySets();
+// the predefined strategy called name; throws if there is none
+StrategyParams findStrategy(const std::string& name);
+
+// round-robin tournament of the predefined strategies
+void runDifferentStrategy(const RunOptions& options = RunOptions());
+// QAgent training of both players' parameters
+void runParameterExperiment(const RunOptions& options = RunOptions());
+// CMA-ES training of both players' parameters
+void runCmaEsTraining(const RunOptions& options);
+// games QAgent and CMA-ES need to beat options.opponent
+void runOptimizerComparison(const RunOptions& options);
+// tournament report of a results file, optionally exporting the rate tables
+void runResultReport(const std::string& path, const std::string& ratesPrefix);
+// merges the results files of tournament shards and reports the union
+void runShardMerge(const std::vector<std::string>& paths, const std::string& ratesPrefix);
+// times games over the options.sweep* grid of board and fleet sizes into a CSV file
+void runScalabilitySweep(const std::string& path, const std::string& p1Name,
+                         const std::string& p2Name, const RunOptions& options);
+// steps envCount BatchedEnv games and compares them with the game executor
+void runEnvBenchmark(size_t envCount, const std::string& p1Name, const std::string& p2Name,
+                     const RunOptions& options);
+// plays one seeded game and saves its replay log to path
+void runRecordReplay(const std::string& path, const std::string& p1Name,
+                     const std::string& p2Name, uint64_t seed);
+// prints a replay log, or the state after round `round` when it is not -1
+void runReplay(const std::string& path, int round);
+// plays one seeded game, printing every phase with ConsoleObserver
+void runWatchedGame(const std::string& p1Name, const std::string& p2Name, uint64_t seed);
+// checks (or with update, rewrites) the golden phase hashes; false on a mismatch
+bool runGoldenHashes(const std::string& path, bool update);
+// checks steady-state golden rounds against allocation budgets; false if one is exceeded
+bool runAllocationBudget(int64_t allocationBudget, int64_t byteBudget, int warmup);
+
+}  // namespace tbs
@@ -0,0 +1,539 @@
+// Checkpoint files and the QAgent optimizer of the naval battle engine.
+#pragma once
+
+#include "tbs/engine.h"
+
+namespace tbs {
+
+const char CHECKPOINT_MAGIC[4] = {'T', 'B', 'S', 'C'};
+const uint32_t CHECKPOINT_VERSION = 9;
+
+enum class CheckpointKind : uint32_t { TOURNAMENT = 1, TRAINING = 2, CMAES_TRAINING = 3 };
+
+// Writes a checkpoint to "<path>.tmp" and renames it over <path> on commit(),
+// so a crash mid-write never leaves a half-written checkpoint behind.
+class CheckpointWriter {
+public:
+    CheckpointWriter(const std::string& path, CheckpointKind kind)
+        : path(path), tempPath(path + ".tmp"),
+          out(tempPath, std::ios::binary | std::ios::trunc) {
+        if (!out) {
+            throw std::runtime_error("cannot write checkpoint " + tempPath);
+        }
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        write(CHECKPOINT_VERSION);
+        write(kind);
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        write(static_cast<uint64_t>(value.size()));
+        out.write(value.data(), value.size());
+    }
+
+    template <typename T>
+    void writeVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint64_t>(values.size()));
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void commit() {
+        out.close();
+        if (!out) {
+            throw std::runtime_error("failed writing checkpoint " + tempPath);
+        }
+        std::filesystem::rename(tempPath, path);
+    }
+
+private:
+    std::string path;
+    std::string tempPath;
+    std::ofstream out;
+};
+
+class CheckpointReader {
+public:
+    CheckpointReader(const std::string& path, CheckpointKind kind)
+        : path(path), in(path, std::ios::binary) {
+        if (!in) {
+            throw std::runtime_error("cannot open checkpoint " + path);
+        }
+        char magic[4];
+        in.read(magic, sizeof(magic));
+        if (!in || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error(path + " is not a checkpoint file");
+        }
+        if (read<uint32_t>() != CHECKPOINT_VERSION) {
+            throw std::runtime_error(path + " has an unsupported checkpoint version");
+        }
+        if (read<CheckpointKind>() != kind) {
+            throw std::runtime_error(path + " belongs to a different kind of run");
+        }
+    }
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!in) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        return value;
+    }
+
+    std::string readString() {
+        std::string value(read<uint64_t>(), '\0');
+        in.read(value.data(), value.size());
+        if (!in) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> readVector() {
+        std::vector<T> values(read<uint64_t>());
+        in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+        if (!in) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        return values;
+    }
+
+private:
+    std::string path;
+    std::ifstream in;
+};
+
+// Q-values keyed by StrategyParams quantized to QTable::RESOLUTION. Each of the
+// 7 parameters becomes a 16-bit step index packed into a 128-bit key, stored
+// inline with its value in an open-addressing table (linear probing).
+class QTable {
+public:
+    static constexpr double RESOLUTION = 0.01;
+
+    struct Key {
+        uint64_t lo = 0; // parameters 0-3
+        uint64_t hi = 0; // parameters 4-6, bit 63 marks an occupied slot
+
+        bool operator==(const Key& other) const { return lo == other.lo && hi == other.hi; }
+    };
+
+    QTable() : slots(16), count(0) {}
+
+    static Key makeKey(const std::vector<double>& params) {
+        Key key;
+        for (int i = 0; i < 7; ++i) {
+            double step = std::round(params[i] / RESOLUTION);
+            step = std::clamp(step, -32768.0, 32767.0);
+            uint64_t bits = static_cast<uint16_t>(static_cast<int16_t>(step));
+            if (i < 4) key.lo |= bits << (i * 16);
+            else key.hi |= bits << ((i - 4) * 16);
+        }
+        key.hi |= OCCUPIED;
+        return key;
+    }
+
+    const double* find(const Key& key) const {
+        const Slot& slot = slots[probe(key)];
+        return slot.key == key ? &slot.value : nullptr;
+    }
+
+    // returns the value slot for key, inserting initial if the key is new
+    double& insert(const Key& key, double initial, bool& inserted) {
+        size_t index = probe(key);
+        inserted = !(slots[index].key == key);
+        if (inserted) {
+            if ((count + 1) * 10 > slots.size() * 7) {
+                grow();
+                index = probe(key);
+            }
+            slots[index] = Slot{key, initial};
+            ++count;
+        }
+        return slots[index].value;
+    }
+
+    size_t size() const { return count; }
+
+    void clear() {
+        slots.assign(16, Slot());
+        count = 0;
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const Slot& slot : slots) {
+            if (slot.key.hi & OCCUPIED) visit(slot.key, slot.value);
+        }
+    }
+
+private:
+    static const uint64_t OCCUPIED = 1ULL << 63;
+
+    struct Slot {
+        Key key;
+        double value = 0.0;
+    };
+
+    std::vector<Slot> slots; // size is a power of two
+    size_t count;
+
+    static uint64_t hash(const Key& key) {
+        return mixSeed(key.lo, key.hi);
+    }
+
+    // index of the key's slot, or of the empty slot where it would go
+    size_t probe(const Key& key) const {
+        size_t mask = slots.size() - 1;
+        size_t index = hash(key) & mask;
+        while ((slots[index].key.hi & OCCUPIED) && !(slots[index].key == key)) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        for (const Slot& slot : old) {
+            if (slot.key.hi & OCCUPIED) slots[probe(slot.key)] = slot;
+        }
+    }
+};
+
+// Scrambled Sobol points in [0,1)^7. The direction numbers (Joe and Kuo) get a
+// random linear matrix scramble and a random digital shift (Matousek), so a
+// sequence is still low-discrepancy but differs per seed. Points are produced
+// in Gray code order; seek() jumps straight to any index.
+class SobolSequence {
+public:
+    static constexpr int DIMENSIONS = 7;
+    static constexpr int BITS = 32;
+
+    explicit SobolSequence(uint64_t seed) : seed(seed) {
+        // degree s, coefficients a and initial m values of dimensions 2..7
+        static const struct { int s; uint32_t a; uint32_t m[4]; } PRIMITIVES[DIMENSIONS - 1] = {
+            {1, 0, {1}}, {2, 1, {1, 3}}, {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}}, {4, 1, {1, 1, 3, 3}}, {4, 4, {1, 3, 5, 13}}
+        };
+
+        std::mt19937_64 gen(seed);
+        for (int d = 0; d < DIMENSIONS; ++d) {
+            uint32_t v[BITS];
+            if (d == 0) {
+                for (int k = 0; k < BITS; ++k) v[k] = 1u << (BITS - 1 - k);
+            } else {
+                const auto& p = PRIMITIVES[d - 1];
+                for (int k = 0; k < p.s; ++k) v[k] = p.m[k] << (BITS - 1 - k);
+                for (int k = p.s; k < BITS; ++k) {
+                    v[k] = v[k - p.s] ^ (v[k - p.s] >> p.s);
+                    for (int j = 1; j < p.s; ++j) {
+                        if ((p.a >> (p.s - 1 - j)) & 1) v[k] ^= v[k - j];
+                    }
+                }
+            }
+
+            // column j of a random lower triangular matrix with unit diagonal
+            uint32_t columns[BITS];
+            for (int j = 0; j < BITS; ++j) {
+                uint32_t diagonal = 1u << (BITS - 1 - j);
+                columns[j] = diagonal | (static_cast<uint32_t>(gen()) & (diagonal - 1));
+            }
+            for (int k = 0; k < BITS; ++k) {
+                uint32_t scrambled = 0;
+                for (int j = 0; j < BITS; ++j) {
+                    if (v[k] & (1u << (BITS - 1 - j))) scrambled ^= columns[j];
+                }
+                directions[d][k] = scrambled;
+            }
+            shift[d] = static_cast<uint32_t>(gen());
+        }
+        seek(0);
+    }
+
+    uint64_t getSeed() const { return seed; }
+    uint64_t getIndex() const { return index; }
+
+    void seek(uint64_t newIndex) {
+        index = newIndex;
+        uint64_t gray = index ^ (index >> 1);
+        for (int d = 0; d < DIMENSIONS; ++d) {
+            point[d] = shift[d];
+            for (int k = 0; k < BITS; ++k) {
+                if ((gray >> k) & 1) point[d] ^= directions[d][k];
+            }
+        }
+    }
+
+    std::array<double, DIMENSIONS> next() {
+        std::array<double, DIMENSIONS> u;
+        for (int d = 0; d < DIMENSIONS; ++d) u[d] = point[d] * 0x1p-32;
+
+        // Gray code successor: flip the direction of the lowest zero bit
+        int bit = std::countr_one(index);
+        for (int d = 0; d < DIMENSIONS; ++d) point[d] ^= directions[d][bit];
+        ++index;
+        return u;
+    }
+
+private:
+    uint64_t seed;
+    uint64_t index = 0;
+    uint32_t directions[DIMENSIONS][BITS];
+    uint32_t shift[DIMENSIONS];
+    uint32_t point[DIMENSIONS];
+};
+
+class QAgent {
+private:
+    QTable qTable;
+    std::vector<double> currentBestParams;
+    double bestQValue;
+    double learningRate;
+    double discountFactor;
+    double explorationRate;
+    std::mt19937 rng;
+    std::string agentName;
+    bool isFirstPlayer;
+    int updateCount;
+    bool verbose = true;
+    double initialExplorationRate;
+    ExplorationMode explorationMode = ExplorationMode::UNIFORM;
+    SobolSequence sobol{0};
+
+public:
+    QAgent(std::string name, bool isFirst, double lr = 0.1, double gamma = 0.95, double epsilon = 0.3)
+        : agentName(name), isFirstPlayer(isFirst), learningRate(lr),
+          discountFactor(gamma), explorationRate(epsilon), updateCount(0),
+          initialExplorationRate(epsilon) {
+        std::random_device rd;
+        rng = std::mt19937(rd());
+
+        StrategyParams initial(isFirst);
+        currentBestParams = {
+            initial.healthWeight,
+            initial.missileWeight,
+            initial.blockWeight,
+            initial.targetWeight,
+            initial.enemyDistanceWeight,
+            initial.allyDistanceWeight,
+            initial.attackThreshold
+        };
+        bestQValue = 0.0;
+
+        bool inserted;
+        qTable.insert(QTable::makeKey(currentBestParams), bestQValue, inserted);
+    }
+
+    StrategyParams getAction() {
+        if (explorationMode == ExplorationMode::UNIFORM) {
+            return sampleAction(currentBestParams, explorationRate, rng);
+        }
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        if (dist(rng) < explorationRate) return explore();
+        return paramsFromVector(currentBestParams);
+    }
+
+    // a random perturbation of the best parameters
+    StrategyParams explore() {
+        if (explorationMode == ExplorationMode::UNIFORM) {
+            return perturb(currentBestParams, rng);
+        }
+        return perturbSobol(currentBestParams, getExplorationRadius(), sobol);
+    }
+
+    // SOBOL draws perturbations from a scrambled Sobol sequence within a radius
+    // that shrinks with the exploration rate; UNIFORM keeps the fixed +-0.5 box
+    void setExplorationMode(ExplorationMode mode, uint64_t sobolSeed) {
+        explorationMode = mode;
+        sobol = SobolSequence(sobolSeed);
+    }
+
+    double getExplorationRadius() const {
+        return SOBOL_RADIUS * explorationRate / initialExplorationRate;
+    }
+
+    // makes the explore/exploit choices and uniform perturbations reproducible
+    void seedRandom(uint64_t seed) {
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        rng.seed(seq);
+    }
+
+    static constexpr double SOBOL_RADIUS = 0.5;
+
+    static StrategyParams perturbSobol(const std::vector<double>& bestParams, double radius,
+                                       SobolSequence& sequence) {
+        std::array<double, SobolSequence::DIMENSIONS> u = sequence.next();
+        std::vector<double> newParams(7);
+        for (size_t i = 0; i < 7; i++) {
+            newParams[i] = bestParams[i] + (u[i] * 2 - 1) * radius;
+        }
+        return paramsFromVector(newParams);
+    }
+
+    // getAction for callers holding a copy of an agent's best parameters and
+    // exploration rate, e.g. actor threads
+    static StrategyParams sampleAction(const std::vector<double>& bestParams,
+                                       double explorationRate, std::mt19937& gen) {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+        if (dist(gen) < explorationRate) {
+            return perturb(bestParams, gen);
+        }
+
+        return StrategyParams(
+            bestParams[0], bestParams[1], bestParams[2],
+            bestParams[3], bestParams[4], bestParams[5],
+            bestParams[6]
+        );
+    }
+
+    static StrategyParams perturb(const std::vector<double>& bestParams, std::mt19937& gen) {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        std::vector<double> newParams(7);
+
+        for (size_t i = 0; i < 7; i++) {
+            double baseValue = bestParams[i];
+            double variation = 0.5;
+            newParams[i] = baseValue + (dist(gen) * 2 - 1) * variation;
+        }
+
+        return StrategyParams(
+            newParams[0], newParams[1], newParams[2],
+            newParams[3], newParams[4], newParams[5], newParams[6]
+        );
+    }
+
+    void update(const StrategyParams& params, double reward) {
+        updateBatch({{params, reward}});
+    }
+
+    // Applies all rewards of a generation first and only then moves the best
+    // parameters, to the best updated state of the batch.
+    void updateBatch(const std::vector<std::pair<StrategyParams, double>>& samples) {
+        std::vector<double> bestState;
+        double bestBatchValue = bestQValue;
+
+        for (const auto& [params, reward] : samples) {
+            std::vector<double> state = paramsToVector(params);
+
+            bool inserted;
+            double& qValue = qTable.insert(QTable::makeKey(state), reward, inserted);
+            if (!inserted) {
+                qValue = (1 - learningRate) * qValue +
+                         learningRate * reward;
+            }
+
+            if (qValue > bestBatchValue) {
+                bestBatchValue = qValue;
+                bestState = state;
+            }
+        }
+
+
+        if (!bestState.empty()) {
+            bestQValue = bestBatchValue;
+            currentBestParams = bestState;
+            updateCount++;
+            if (!verbose) return;
+
+            std::cout << "\n" << agentName << " - Update #" << updateCount << ":\n";
+            std::cout << "New Q-Value: " << bestQValue << "\n";
+            printCurrentState(bestState);
+        }
+    }
+
+
+    void printCurrentState(const std::vector<double>& state) const {
+        std::cout << "Parameters:\n";
+        std::cout << "Health Weight: " << std::fixed << std::setprecision(3)
+                 << state[0] << "\n";
+        std::cout << "Missile Weight: " << state[1] << "\n";
+        std::cout << "Block Weight: " << state[2] << "\n";
+        std::cout << "Target Weight: " << state[3] << "\n";
+        std::cout << "Enemy Distance Weight: " << state[4] << "\n";
+        std::cout << "Ally Distance Weight: " << state[5] << "\n";
+        std::cout << "Attack Threshold: " << state[6] << "\n";
+    }
+
+    void printBestParameters() const {
+        std::cout << "\n" << agentName << " Best Parameters:\n";
+        std::cout << "Health Weight: " << std::fixed << std::setprecision(3)
+                 << currentBestParams[0] << "\n";
+        std::cout << "Missile Weight: " << currentBestParams[1] << "\n";
+        std::cout << "Block Weight: " << currentBestParams[2] << "\n";
+        std::cout << "Target Weight: " << currentBestParams[3] << "\n";
+        std::cout << "Enemy Distance Weight: " << currentBestParams[4] << "\n";
+        std::cout << "Ally Distance Weight: " << currentBestParams[5] << "\n";
+        std::cout << "Attack Threshold: " << currentBestParams[6] << "\n";
+        std::cout << "Q-Value: " << bestQValue << "\n";
+        std::cout << "Total Updates: " << updateCount << "\n";
+    }
+
+    void decay_exploration(double decay_rate = 0.997) {
+        explorationRate *= decay_rate;
+        explorationRate = std::max(0.05, explorationRate);
+    }
+
+    double getExplorationRate() const { return explorationRate; }
+    const std::vector<double>& getBestParams() const { return currentBestParams; }
+    double getBestQValue() const { return bestQValue; }
+
+    // silences the per-update parameter dump
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+    void saveState(CheckpointWriter& out) const {
+        out.write(static_cast<uint64_t>(qTable.size()));
+        qTable.forEach([&](const QTable::Key& key, double value) {
+            out.write(key);
+            out.write(value);
+        });
+        out.writeVector(currentBestParams);
+        out.write(bestQValue);
+        out.write(explorationRate);
+        out.write(updateCount);
+
+        std::ostringstream rngState;
+        rngState << rng;
+        out.writeString(rngState.str());
+
+        out.write(static_cast<uint8_t>(explorationMode));
+        out.write(sobol.getSeed());
+        out.write(sobol.getIndex());
+    }
+
+    void loadState(CheckpointReader& in) {
+        qTable.clear();
+        uint64_t entries = in.read<uint64_t>();
+        for (uint64_t i = 0; i < entries; ++i) {
+            QTable::Key key = in.read<QTable::Key>();
+            bool inserted;
+            qTable.insert(key, 0.0, inserted) = in.read<double>();
+        }
+        currentBestParams = in.readVector<double>();
+        bestQValue = in.read<double>();
+        explorationRate = in.read<double>();
+        updateCount = in.read<int>();
+
+        std::istringstream rngState(in.readString());
+        rngState >> rng;
+
+        if (static_cast<ExplorationMode>(in.read<uint8_t>()) != explorationMode) {
+            throw std::runtime_error("checkpoint was written with a different --exploration mode");
+        }
+        uint64_t sobolSeed = in.read<uint64_t>();
+        uint64_t sobolIndex = in.read<uint64_t>();
+        sobol = SobolSequence(sobolSeed);
+        sobol.seek(sobolIndex);
+    }
+};
+
+}  // namespace tbs
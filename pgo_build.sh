@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Builds the profile-guided, link-time optimized release of the simulator and
+# reports its speedup over the plain Release build:
+#   1. plain Release build (build-release), the reference
+#   2. instrumented build (build-pgo), trained on a seeded tournament slice
+#   3. the same build directory rebuilt with the profile and LTO
+#   4. the benchmark suite's gate workload of build 3 against build 1, on a
+#      seed kept out of training; exits non-zero if the gate reports a regression
+# Usage: ./pgo_build.sh [training shard count, default 10] [gate runs, default 5]
+set -euo pipefail
+
+SHARDS=${1:-10}
+RUNS=${2:-5}
+ROOT=$(cd "$(dirname "$0")" && pwd)
+PROFILE_DIR="$ROOT/build-pgo/pgo-data"
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+configure() {
+    cmake -S "$ROOT" -B "$ROOT/$1" -DCMAKE_BUILD_TYPE=Release "${@:2}"
+    cmake --build "$ROOT/$1" -j"$JOBS"
+}
+
+configure build-release
+
+# GCC names the profile files after the object paths, so the instrumented and
+# the optimized build share build-pgo
+configure build-pgo -DTBS_PGO=GENERATE -DTBS_PGO_DIR="$PROFILE_DIR" -DTBS_LTO=OFF
+rm -rf "$PROFILE_DIR"
+# training workload: one round-robin shard of the seeded tournament (every
+# matchup in its usual mix); the benchmark workload stays out of the profile
+"$ROOT/build-pgo/TurnBaseShipSimulator" --seed 1 --shard "0/$SHARDS" > /dev/null
+if ls "$PROFILE_DIR"/*.profraw > /dev/null 2>&1; then
+    # Clang writes raw profiles that have to be merged
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+configure build-pgo -DTBS_PGO=USE -DTBS_LTO=ON
+
+# the gate replays the seed stored in the baseline
+GATE_SEED=2
+"$ROOT/build-release/TurnBaseShipBenchmark" --write-baseline "$ROOT/build-release/release.json" \
+    --seed "$GATE_SEED" --runs "$RUNS"
+"$ROOT/build-pgo/TurnBaseShipBenchmark" --gate "$ROOT/build-release/release.json" --runs "$RUNS"
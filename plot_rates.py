@@ -0,0 +1,40 @@
+"""Regenerates win_rate.png, draw_rate.png and lose_rate.png from the CSV
+tables written by `TurnBaseShipSimulator --report <file> --export-rates <prefix>`."""
+import csv
+import sys
+
+import matplotlib.pyplot as plt
+
+
+def plot(csv_path, png_path, title, label):
+    with open(csv_path) as f:
+        rows = list(csv.reader(f))
+    p2_names = rows[0][1:]
+    p1_names = [row[0] for row in rows[1:]]
+    values = [[float(v) for v in row[1:]] for row in rows[1:]]
+
+    fig, ax = plt.subplots(figsize=(10, 10))
+    image = ax.imshow(values, cmap="RdYlGn", vmin=0.0, vmax=1.0)
+    fig.colorbar(image, ax=ax, label=label)
+
+    ax.set_xticks(range(len(p2_names)))
+    ax.set_xticklabels(p2_names, rotation=45, ha="right")
+    ax.set_yticks(range(len(p1_names)))
+    ax.set_yticklabels(p1_names)
+    ax.set_xlabel("Player 2 Strategies", fontsize=12)
+    ax.set_ylabel("Player 1 Strategies", fontsize=12)
+    ax.set_title(title, fontsize=16)
+
+    for i, row in enumerate(values):
+        for j, value in enumerate(row):
+            ax.text(j, i, f"{value * 100:.1f}%", ha="center", va="center")
+
+    fig.savefig(png_path, bbox_inches="tight")
+    plt.close(fig)
+
+
+if __name__ == "__main__":
+    prefix = sys.argv[1] if len(sys.argv) > 1 else ""
+    plot(prefix + "win_rate.csv", "win_rate.png", "Strategy Win rate", "Win Rate (%)")
+    plot(prefix + "draw_rate.csv", "draw_rate.png", "Strategy Draw rate", "Draw Rate (%)")
+    plot(prefix + "lose_rate.csv", "lose_rate.png", "Strategy Lose rate", "Lose Rate (%)")
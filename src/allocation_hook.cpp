@@ -0,0 +1,38 @@
+// Replaces the global operator new and delete to count every heap allocation
+// of the process into tbs::threadAllocations and the heap byte totals. It is
+// compiled into the executables of TBS_WORK_COUNTERS builds only, so programs
+// that embed the engine library keep their own allocator.
+#include "tbs/engine.h"
+
+#ifndef TBS_WORK_COUNTERS
+#error "allocation_hook.cpp belongs to builds with TBS_WORK_COUNTERS"
+#endif
+
+// every block carries its size in a header
+const size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) {
+    ++tbs::threadAllocations;
+    tbs::threadAllocatedBytes += size;
+    void* block = std::malloc(size + ALLOCATION_HEADER);
+    if (!block) throw std::bad_alloc();
+    *static_cast<std::size_t*>(block) = size;
+
+    int64_t live = tbs::liveHeapBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = tbs::peakHeapBytes.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !tbs::peakHeapBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return static_cast<char*>(block) + ALLOCATION_HEADER;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#pragma GCC diagnostic ignored "-Warray-bounds"  // reads the header in front of inlined blocks
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    char* block = static_cast<char*>(p) - ALLOCATION_HEADER;
+    tbs::liveHeapBytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+#pragma GCC diagnostic pop
@@ -0,0 +1,3446 @@
+// Implementation of the naval battle engine: results files, replays, the
+// tournament, training and analysis runners. The game model itself lives in
+// the public headers.
+#include "tbs/engine.h"
+#include "tbs/training.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace tbs {
+
+thread_local Tracer::Lease Tracer::lease;
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "result files are written in little-endian byte order");
+
+const uint16_t UNNAMED_STRATEGY = 0xFFFF;
+
+// one row of the per-game results stream
+struct GameRecord {
+    uint64_t seed;
+    uint16_t p1Strategy; // index into the file's strategy table, UNNAMED_STRATEGY for ad-hoc params
+    uint16_t p2Strategy;
+    StrategyParams p1Params;
+    StrategyParams p2Params;
+    Game::GameResult result;
+};
+
+// Column layout of a results block. Every block stores rowCount values of
+// each column back to back, so aggregations only touch the columns they need.
+enum ResultColumn {
+    COL_SEED,
+    COL_P1_STRATEGY,
+    COL_P2_STRATEGY,
+    COL_P1_PARAMS,                 // 7 float columns
+    COL_P2_PARAMS = COL_P1_PARAMS + 7, // 7 float columns
+    COL_ROUNDS = COL_P2_PARAMS + 7,
+    COL_P1_SHIPS,
+    COL_P1_HEALTH,
+    COL_P2_SHIPS,
+    COL_P2_HEALTH,
+    COL_WINNER,
+    COL_DURATION,
+    COL_PHASE_SECONDS,             // TIMED_PHASE_COUNT float columns, since version 2
+    RESULT_COLUMN_COUNT = COL_PHASE_SECONDS + TIMED_PHASE_COUNT
+};
+
+const size_t RESULT_COLUMN_WIDTH[RESULT_COLUMN_COUNT] = {
+    8, 2, 2,
+    4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4,
+    2, 1, 2, 1, 2, 1, 4,
+    4, 4, 4, 4, 4, 4
+};
+
+const char RESULT_FILE_MAGIC[4] = {'T', 'B', 'S', 'R'};
+const char RESULT_BLOCK_MAGIC[4] = {'B', 'L', 'K', '1'};
+const uint32_t RESULT_FILE_VERSION = 3;
+
+class ResultWriter {
+public:
+    static const uint32_t BLOCK_ROWS = 4096;
+
+    // A non-zero resumeSize reopens a file written by an interrupted run: it is
+    // cut back to that size (the end of the last checkpointed block) and appended to.
+    ResultWriter(const std::string& path, const std::vector<std::string>& strategyNames,
+                 uint32_t gamesPerMatchup, uint64_t baseSeed, uint64_t resumeSize = 0)
+        : pendingRows(0) {
+        for (int c = 0; c < RESULT_COLUMN_COUNT; ++c) {
+            columns[c].reserve(BLOCK_ROWS * RESULT_COLUMN_WIDTH[c]);
+        }
+
+        if (resumeSize > 0) {
+            std::filesystem::resize_file(path, resumeSize);
+            out.open(path, std::ios::binary | std::ios::app);
+            if (!out) {
+                throw std::runtime_error("cannot reopen results file " + path);
+            }
+            return;
+        }
+
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot open results file " + path);
+        }
+        out.write(RESULT_FILE_MAGIC, sizeof(RESULT_FILE_MAGIC));
+        writeValue(out, RESULT_FILE_VERSION);
+        writeValue(out, gamesPerMatchup);
+        writeValue(out, baseSeed);
+        writeValue(out, static_cast<uint32_t>(strategyNames.size()));
+        for (const std::string& name : strategyNames) {
+            writeValue(out, static_cast<uint16_t>(name.size()));
+            out.write(name.data(), name.size());
+        }
+    }
+
+    ~ResultWriter() { flush(); }
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // size of the file up to the last written block
+    uint64_t getWrittenSize() { return static_cast<uint64_t>(out.tellp()); }
+
+    void append(const GameRecord& record) {
+        put(COL_SEED, record.seed);
+        put(COL_P1_STRATEGY, record.p1Strategy);
+        put(COL_P2_STRATEGY, record.p2Strategy);
+
+        std::vector<double> p1 = paramsToVector(record.p1Params);
+        std::vector<double> p2 = paramsToVector(record.p2Params);
+        for (int i = 0; i < 7; ++i) {
+            put(COL_P1_PARAMS + i, static_cast<float>(p1[i]));
+            put(COL_P2_PARAMS + i, static_cast<float>(p2[i]));
+        }
+
+        const Game::GameResult& r = record.result;
+        put(COL_ROUNDS, static_cast<uint16_t>(r.rounds));
+        put(COL_P1_SHIPS, static_cast<uint8_t>(r.p1Ships));
+        put(COL_P1_HEALTH, static_cast<uint16_t>(r.p1Health));
+        put(COL_P2_SHIPS, static_cast<uint8_t>(r.p2Ships));
+        put(COL_P2_HEALTH, static_cast<uint16_t>(r.p2Health));
+        put(COL_WINNER, static_cast<uint8_t>(r.winner));
+        put(COL_DURATION, static_cast<float>(r.duration));
+        for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+            put(COL_PHASE_SECONDS + phase, static_cast<float>(r.phaseSeconds[phase]));
+        }
+
+        if (++pendingRows == BLOCK_ROWS) flush();
+    }
+
+    // writes the buffered rows as one block
+    void flush() {
+        if (pendingRows == 0) return;
+
+        out.write(RESULT_BLOCK_MAGIC, sizeof(RESULT_BLOCK_MAGIC));
+        writeValue(out, pendingRows);
+        for (auto& column : columns) {
+            out.write(reinterpret_cast<const char*>(column.data()), column.size());
+            column.clear();
+        }
+        out.flush();
+        pendingRows = 0;
+    }
+
+private:
+    std::ofstream out;
+    std::vector<unsigned char> columns[RESULT_COLUMN_COUNT];
+    uint32_t pendingRows;
+
+    template <typename T>
+    void put(int column, T value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        columns[column].insert(columns[column].end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    static void writeValue(std::ofstream& stream, T value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+};
+
+// read-only memory mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if (size > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data = static_cast<const unsigned char*>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat st;
+        fstat(fd, &st);
+        size = static_cast<size_t>(st.st_size);
+        if (size > 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(mapped);
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+#endif
+        if (size > 0 && data == nullptr) {
+            throw std::runtime_error("cannot map " + path);
+        }
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+// Reader for files produced by ResultWriter. Column data is used in place from
+// the mapping; nothing is copied until a value is requested.
+class ResultFile {
+public:
+    struct Block {
+        uint32_t rows;
+        const unsigned char* columns[RESULT_COLUMN_COUNT]; // null if the file version lacks it
+
+        template <typename T>
+        T get(int column, size_t row) const {
+            T value{};
+            if (columns[column]) {
+                std::memcpy(&value, columns[column] + row * sizeof(T), sizeof(T));
+            }
+            return value;
+        }
+
+        Game::GameResult getResult(size_t row) const {
+            Game::GameResult result{
+                get<uint16_t>(COL_ROUNDS, row),
+                get<uint8_t>(COL_P1_SHIPS, row),
+                get<uint16_t>(COL_P1_HEALTH, row),
+                get<uint8_t>(COL_P2_SHIPS, row),
+                get<uint16_t>(COL_P2_HEALTH, row),
+                get<uint8_t>(COL_WINNER, row),
+                get<float>(COL_DURATION, row)
+            };
+            for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+                result.phaseSeconds[phase] = get<float>(COL_PHASE_SECONDS + phase, row);
+            }
+            return result;
+        }
+    };
+
+    explicit ResultFile(const std::string& path) : file(path), path(path) {
+        size_t offset = 0;
+        char magic[4];
+        readBytes(offset, magic, sizeof(magic));
+        if (std::memcmp(magic, RESULT_FILE_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error(path + " is not a results file");
+        }
+        uint32_t version = readValue<uint32_t>(offset);
+        if (version < 1 || version > RESULT_FILE_VERSION) {
+            throw std::runtime_error(path + " has unsupported version " +
+                                     std::to_string(version));
+        }
+        // version 1 files end before the phase timings
+        int columnCount = version == 1 ? COL_PHASE_SECONDS : RESULT_COLUMN_COUNT;
+        gamesPerMatchup = readValue<uint32_t>(offset);
+        // the base seed is stored since version 3
+        if (version >= 3) baseSeed = readValue<uint64_t>(offset);
+        uint32_t nameCount = readValue<uint32_t>(offset);
+        for (uint32_t i = 0; i < nameCount; ++i) {
+            uint16_t length = readValue<uint16_t>(offset);
+            std::string name(length, '\0');
+            readBytes(offset, name.data(), length);
+            strategyNames.push_back(name);
+        }
+
+        size_t rowBytes = 0;
+        for (int c = 0; c < columnCount; ++c) rowBytes += RESULT_COLUMN_WIDTH[c];
+
+        // a block cut short by a crash is ignored rather than rejected
+        while (offset + sizeof(RESULT_BLOCK_MAGIC) + sizeof(uint32_t) <= file.getSize()) {
+            readBytes(offset, magic, sizeof(magic));
+            if (std::memcmp(magic, RESULT_BLOCK_MAGIC, sizeof(magic)) != 0) {
+                throw std::runtime_error(path + " is corrupt at offset " +
+                                         std::to_string(offset));
+            }
+            Block block;
+            block.rows = readValue<uint32_t>(offset);
+            if (offset + rowBytes * block.rows > file.getSize()) break;
+
+            for (int c = 0; c < RESULT_COLUMN_COUNT; ++c) {
+                block.columns[c] = c < columnCount ? file.getData() + offset : nullptr;
+                if (c < columnCount) offset += RESULT_COLUMN_WIDTH[c] * block.rows;
+            }
+            rowCount += block.rows;
+            blocks.push_back(block);
+        }
+    }
+
+    const std::vector<std::string>& getStrategyNames() const { return strategyNames; }
+    uint32_t getGamesPerMatchup() const { return gamesPerMatchup; }
+    std::optional<uint64_t> getBaseSeed() const { return baseSeed; }
+    const std::vector<Block>& getBlocks() const { return blocks; }
+    size_t getRowCount() const { return rowCount; }
+
+    static GameRecord getRecord(const Block& block, size_t row) {
+        std::vector<double> p1(7), p2(7);
+        for (int i = 0; i < 7; ++i) {
+            p1[i] = block.get<float>(COL_P1_PARAMS + i, row);
+            p2[i] = block.get<float>(COL_P2_PARAMS + i, row);
+        }
+        Game::GameResult result = block.getResult(row);
+        return GameRecord{block.get<uint64_t>(COL_SEED, row),
+                          block.get<uint16_t>(COL_P1_STRATEGY, row),
+                          block.get<uint16_t>(COL_P2_STRATEGY, row),
+                          paramsFromVector(p1), paramsFromVector(p2), result};
+    }
+
+private:
+    MappedFile file;
+    std::string path;
+    uint32_t gamesPerMatchup = 0;
+    std::optional<uint64_t> baseSeed; // empty for files older than version 3
+    std::vector<std::string> strategyNames;
+    std::vector<Block> blocks;
+    size_t rowCount = 0;
+
+    void readBytes(size_t& offset, void* dest, size_t count) const {
+        if (offset + count > file.getSize()) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        std::memcpy(dest, file.getData() + offset, count);
+        offset += count;
+    }
+
+    template <typename T>
+    T readValue(size_t& offset) const {
+        T value;
+        readBytes(offset, &value, sizeof(T));
+        return value;
+    }
+};
+
+const char REPLAY_MAGIC[4] = {'T', 'B', 'R', 'P'};
+const uint8_t REPLAY_VERSION = 1;
+
+// Replay event tags; the low bit of a tag byte holds the player (0 = player 1).
+enum ReplayEvent : uint8_t {
+    EVENT_PLACE,    // ship, placement delta from the player's previous placement
+    EVENT_ROUND,    // a new round starts
+    EVENT_ATTACK,   // ship * 2 + missile type, target delta from the shooter
+    EVENT_MOVE,     // ship, position delta
+    EVENT_TRIGGER,  // ship whose chosen attack fired this round
+    EVENT_HIT,      // ship, damage taken
+    EVENT_END
+};
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeSignedVarint(std::vector<uint8_t>& out, int64_t value) {
+    writeVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+uint64_t readVarint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (offset >= in.size()) {
+            throw std::runtime_error("replay log is truncated");
+        }
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("replay log has a malformed varint");
+}
+
+int64_t readSignedVarint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint64_t value = readVarint(in, offset);
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Records a game as a compact event log. Observe a BasicGame<ReplayRecorder>
+// with it (setObserver) before run().
+class ReplayRecorder : public NoObserver {
+public:
+    template <typename G>
+    explicit ReplayRecorder(const G& game) {
+        bytes.assign(REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC));
+        bytes.push_back(REPLAY_VERSION);
+        writeVarint(bytes, game.getSeed());
+
+        for (int id = 1; id <= 2; ++id) {
+            const Player& player = game.getPlayer(id);
+            for (double value : paramsToVector(player.getParams())) {
+                float f = static_cast<float>(value);
+                const uint8_t* raw = reinterpret_cast<const uint8_t*>(&f);
+                bytes.insert(bytes.end(), raw, raw + sizeof(f));
+            }
+
+            writeVarint(bytes, player.getShips().size());
+            for (const Ship& ship : player.getShips()) {
+                writeVarint(bytes, ship.getMaxHealth());
+                writeVarint(bytes, ship.getMoveRange());
+                writeVarint(bytes, ship.getCrossMissiles());
+                writeVarint(bytes, ship.getSquareMissiles());
+            }
+            positions[id - 1].resize(player.getShips().size());
+        }
+    }
+
+    void onPlacement(int player, int ship, const Position& pos) {
+        Position delta = pos - lastPlacement[player - 1];
+        writeEvent(EVENT_PLACE, player);
+        writeVarint(bytes, ship);
+        writeSignedVarint(bytes, delta.x);
+        writeSignedVarint(bytes, delta.y);
+        lastPlacement[player - 1] = pos;
+        positions[player - 1][ship] = pos;
+    }
+
+    void onRoundStart(int /*round*/) {
+        writeEvent(EVENT_ROUND, 1);
+    }
+
+    void onAttackChosen(int player, int ship, const Position& target,
+                        Missile::Type type) {
+        Position delta = target - positions[player - 1][ship];
+        writeEvent(EVENT_ATTACK, player);
+        writeVarint(bytes, ship * 2 + (type == Missile::SQUARE ? 1 : 0));
+        writeSignedVarint(bytes, delta.x);
+        writeSignedVarint(bytes, delta.y);
+    }
+
+    void onMove(int player, int ship, const Position& to) {
+        Position delta = to - positions[player - 1][ship];
+        if (delta.x == 0 && delta.y == 0) return;
+
+        writeEvent(EVENT_MOVE, player);
+        writeVarint(bytes, ship);
+        writeSignedVarint(bytes, delta.x);
+        writeSignedVarint(bytes, delta.y);
+        positions[player - 1][ship] = to;
+    }
+
+    void onAttackTriggered(int player, int ship) {
+        writeEvent(EVENT_TRIGGER, player);
+        writeVarint(bytes, ship);
+    }
+
+    void onHit(int player, int ship, int damage) {
+        writeEvent(EVENT_HIT, player);
+        writeVarint(bytes, ship);
+        writeVarint(bytes, damage);
+    }
+
+    void onGameEnd(const GameResult& /*result*/) {
+        writeEvent(EVENT_END, 1);
+    }
+
+    const std::vector<uint8_t>& getBytes() const { return bytes; }
+
+    void save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (!out) {
+            throw std::runtime_error("cannot write replay " + path);
+        }
+    }
+
+private:
+    std::vector<uint8_t> bytes;
+    std::vector<Position> positions[2];
+    Position lastPlacement[2];
+
+    void writeEvent(ReplayEvent event, int player) {
+        bytes.push_back(static_cast<uint8_t>((event << 1) | (player - 1)));
+    }
+};
+
+struct ReplayShip {
+    Position position;
+    int health;
+    int maxHealth;
+    int moveRange;
+    int crossMissiles;
+    int squareMissiles;
+
+    bool isDead() const { return health <= 0; }
+};
+
+struct ReplayState {
+    int round = 0;
+    bool finished = false;
+    std::vector<ReplayShip> fleets[2];
+};
+
+// Rebuilds game states from a replay log by applying its events; no decision
+// logic runs, so seeking to any round costs a single pass over the log.
+class Replay {
+public:
+    explicit Replay(std::vector<uint8_t> data) : bytes(std::move(data)) {
+        size_t offset = 0;
+        if (bytes.size() < sizeof(REPLAY_MAGIC) + 1 ||
+            std::memcmp(bytes.data(), REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0) {
+            throw std::runtime_error("not a replay log");
+        }
+        offset += sizeof(REPLAY_MAGIC);
+        if (bytes[offset++] != REPLAY_VERSION) {
+            throw std::runtime_error("unsupported replay version");
+        }
+        seed = readVarint(bytes, offset);
+
+        for (int p = 0; p < 2; ++p) {
+            std::vector<double> values(7);
+            for (double& value : values) {
+                float f;
+                if (offset + sizeof(f) > bytes.size()) {
+                    throw std::runtime_error("replay log is truncated");
+                }
+                std::memcpy(&f, bytes.data() + offset, sizeof(f));
+                offset += sizeof(f);
+                value = f;
+            }
+            params[p] = values;
+
+            uint64_t shipCount = readVarint(bytes, offset);
+            for (uint64_t i = 0; i < shipCount; ++i) {
+                ReplayShip ship;
+                ship.maxHealth = static_cast<int>(readVarint(bytes, offset));
+                ship.health = ship.maxHealth;
+                ship.moveRange = static_cast<int>(readVarint(bytes, offset));
+                ship.crossMissiles = static_cast<int>(readVarint(bytes, offset));
+                ship.squareMissiles = static_cast<int>(readVarint(bytes, offset));
+                initialState.fleets[p].push_back(ship);
+            }
+        }
+        eventsOffset = offset;
+        roundCount = stateAt(INT32_MAX).round;
+    }
+
+    static Replay load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("cannot open replay " + path);
+        }
+        return Replay(std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                                           std::istreambuf_iterator<char>()));
+    }
+
+    uint64_t getSeed() const { return seed; }
+    StrategyParams getParams(int player) const { return paramsFromVector(params[player - 1]); }
+    int getRoundCount() const { return roundCount; }
+
+    // state at the end of the given round; round 0 is the state after placement
+    ReplayState stateAt(int targetRound) const {
+        ReplayState state = initialState;
+        Position lastPlacement[2];
+        std::vector<std::pair<int, Missile::Type>> attacks[2]; // chosen this round, per ship
+
+        size_t offset = eventsOffset;
+        while (offset < bytes.size()) {
+            uint8_t tag = bytes[offset];
+            ReplayEvent event = static_cast<ReplayEvent>(tag >> 1);
+            int p = tag & 1;
+            if (event == EVENT_ROUND && state.round == targetRound) break;
+            ++offset;
+
+            std::vector<ReplayShip>& fleet = state.fleets[p];
+            switch (event) {
+            case EVENT_PLACE: {
+                ReplayShip& ship = fleet.at(readVarint(bytes, offset));
+                lastPlacement[p].x += static_cast<int>(readSignedVarint(bytes, offset));
+                lastPlacement[p].y += static_cast<int>(readSignedVarint(bytes, offset));
+                ship.position = lastPlacement[p];
+                break;
+            }
+            case EVENT_ROUND:
+                ++state.round;
+                attacks[0].clear();
+                attacks[1].clear();
+                break;
+            case EVENT_ATTACK: {
+                uint64_t value = readVarint(bytes, offset);
+                readSignedVarint(bytes, offset); // the target only matters for display
+                readSignedVarint(bytes, offset);
+                attacks[p].emplace_back(static_cast<int>(value / 2),
+                                        value % 2 ? Missile::SQUARE : Missile::CROSS);
+                break;
+            }
+            case EVENT_MOVE: {
+                ReplayShip& ship = fleet.at(readVarint(bytes, offset));
+                ship.position.x += static_cast<int>(readSignedVarint(bytes, offset));
+                ship.position.y += static_cast<int>(readSignedVarint(bytes, offset));
+                break;
+            }
+            case EVENT_TRIGGER: {
+                int index = static_cast<int>(readVarint(bytes, offset));
+                for (const auto& [ship, type] : attacks[p]) {
+                    if (ship != index) continue;
+                    if (type == Missile::CROSS) --fleet.at(ship).crossMissiles;
+                    else --fleet.at(ship).squareMissiles;
+                    break;
+                }
+                break;
+            }
+            case EVENT_HIT: {
+                ReplayShip& ship = fleet.at(readVarint(bytes, offset));
+                ship.health = std::max(0, ship.health - static_cast<int>(readVarint(bytes, offset)));
+                break;
+            }
+            case EVENT_END:
+                state.finished = true;
+                return state;
+            default:
+                throw std::runtime_error("replay log has an unknown event");
+            }
+        }
+        return state;
+    }
+
+private:
+    std::vector<uint8_t> bytes;
+    size_t eventsOffset = 0;
+    uint64_t seed = 0;
+    std::vector<double> params[2];
+    ReplayState initialState;
+    int roundCount = 0;
+};
+
+void printReplayState(const ReplayState& state) {
+    std::cout << "\nReplayed game state:\n";
+    std::cout << "Round: " << state.round << (state.finished ? " (game over)" : "") << "\n\n";
+
+    for (int p = 0; p < 2; ++p) {
+        std::cout << "Player " << p + 1 << " ships status:\n";
+        int shipNum = 1;
+        for (const ReplayShip& ship : state.fleets[p]) {
+            std::cout << "Ship " << shipNum++ << ": ";
+            if (ship.isDead()) {
+                std::cout << "Destroyed\n";
+            } else {
+                std::cout << "HP=" << ship.health
+                          << ", Cross Missiles=" << ship.crossMissiles
+                          << ", Square Missiles=" << ship.squareMissiles
+                          << ", Position=(" << ship.position.x << ","
+                          << ship.position.y << ")\n";
+            }
+        }
+    }
+    std::cout << "\n";
+}
+
+// Hashes the state after every phase of a game (all ships plus the attacks
+// chosen in that phase), giving a fingerprint of every decision the engine made.
+class StateHasher : public NoObserver {
+public:
+    struct PhaseHash {
+        int round;
+        GamePhase phase;
+        uint64_t hash;
+    };
+
+    template <typename G>
+    explicit StateHasher(const G& game) : players{&game.getPlayer(1), &game.getPlayer(2)} {}
+
+    void onAttackChosen(int player, int ship, const Position& target,
+                        Missile::Type type) {
+        mix(player);
+        mix(ship);
+        mix(target.x);
+        mix(target.y);
+        mix(type);
+    }
+
+    void onPhaseEnd(int round, GamePhase phase) {
+        mix(round);
+        mix(static_cast<int>(phase));
+        for (int id = 1; id <= 2; ++id) {
+            for (const Ship& ship : players[id - 1]->getShips()) {
+                mix(ship.getPosition().x);
+                mix(ship.getPosition().y);
+                mix(ship.getHealth());
+                mix(ship.getCrossMissiles());
+                mix(ship.getSquareMissiles());
+            }
+        }
+        phases.push_back({round, phase, hash});
+        hash = FNV_OFFSET;
+    }
+
+    const std::vector<PhaseHash>& getPhases() const { return phases; }
+
+    // hash of the whole phase stream
+    uint64_t getStreamHash() const {
+        uint64_t stream = FNV_OFFSET;
+        for (const PhaseHash& phase : phases) {
+            for (int i = 0; i < 8; ++i) {
+                stream = (stream ^ ((phase.hash >> (i * 8)) & 0xFF)) * FNV_PRIME;
+            }
+        }
+        return stream;
+    }
+
+private:
+    static const uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+    static const uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+    const Player* players[2];
+    uint64_t hash = FNV_OFFSET;
+    std::vector<PhaseHash> phases;
+
+    void mix(int value) {
+        uint32_t bits = static_cast<uint32_t>(value);
+        for (int i = 0; i < 4; ++i) {
+            hash = (hash ^ ((bits >> (i * 8)) & 0xFF)) * FNV_PRIME;
+        }
+    }
+};
+
+}  // namespace
+
+Game::GameResult playGame(const StrategyParams& p1Params, const StrategyParams& p2Params,
+                          uint64_t seed, const RunOptions& options,
+                          const GameConfig& config, const std::string& replayName) {
+    if (options.replayDir.empty()) return Game(p1Params, p2Params, seed, config).run();
+
+    BasicGame<ReplayRecorder> game(p1Params, p2Params, seed, config);
+    ReplayRecorder recorder(game);
+    game.setObserver(&recorder);
+    Game::GameResult result = game.run();
+
+    std::ostringstream name;
+    if (replayName.empty()) {
+        uint64_t paramsHash = 0;
+        for (const StrategyParams* params : {&p1Params, &p2Params}) {
+            for (double value : paramsToVector(*params)) {
+                paramsHash = mixSeed(paramsHash, std::bit_cast<uint64_t>(value));
+            }
+        }
+        name << std::hex << std::setfill('0') << std::setw(16) << seed << '-'
+             << std::setw(16) << paramsHash;
+    } else {
+        name << replayName;
+    }
+    name << ".tbrp";
+    recorder.save((std::filesystem::path(options.replayDir) / name.str()).string());
+    return result;
+}
+
+double computeReward(const Game::GameResult& result, bool firstPlayer) {
+    int ownShips = firstPlayer ? result.p1Ships : result.p2Ships;
+    int ownHealth = firstPlayer ? result.p1Health : result.p2Health;
+    int enemyShips = firstPlayer ? result.p2Ships : result.p1Ships;
+    int enemyHealth = firstPlayer ? result.p2Health : result.p1Health;
+
+    double reward = (ownShips * 10.0) +
+                    (ownHealth * 1.0) +
+                    (result.winner == (firstPlayer ? 1 : 2) ? 200.0 : -50) -
+                    (enemyShips * 40.0) -
+                    (enemyHealth * 1.5);
+
+    if (ownShips > enemyShips) reward *= 1.2;
+    return reward;
+}
+
+namespace {
+
+// Cheap reward model over StrategyParams for screening candidates before they
+// are simulated: Bayesian linear regression on a quadratic feature map
+// (bias, the 7 parameters and their squares), so it can represent a single
+// peak per parameter. Only the sufficient statistics X'X, X'y and y'y are kept.
+class Surrogate {
+public:
+    static const int FEATURES = 15;
+    static constexpr double RIDGE = 1.0;   // prior precision of the weights
+    static constexpr double KAPPA = 2.0;   // standard deviations in the upper bound
+
+    struct Prediction {
+        double mean;
+        double stddev; // uncertainty of the mean reward, not of a single game
+
+        double upperBound() const { return mean + KAPPA * stddev; }
+    };
+
+    Surrogate() : xtx(FEATURES * FEATURES, 0.0), xty(FEATURES, 0.0) {}
+
+    void add(const StrategyParams& params, double reward) {
+        std::array<double, FEATURES> phi = features(params);
+        for (int i = 0; i < FEATURES; ++i) {
+            for (int j = 0; j < FEATURES; ++j) xtx[i * FEATURES + j] += phi[i] * phi[j];
+            xty[i] += phi[i] * reward;
+        }
+        yty += reward * reward;
+        samples++;
+        dirty = true;
+    }
+
+    // every game of a results file becomes one sample for each side
+    void addResultFile(const std::string& path, bool firstPlayer) {
+        ResultFile file(path);
+        for (const ResultFile::Block& block : file.getBlocks()) {
+            for (size_t row = 0; row < block.rows; ++row) {
+                GameRecord record = ResultFile::getRecord(block, row);
+                add(firstPlayer ? record.p1Params : record.p2Params,
+                    computeReward(record.result, firstPlayer));
+            }
+        }
+    }
+
+    // too few samples to fit every feature: screening must not reject anything yet
+    bool isReady() const { return samples >= 2 * FEATURES; }
+    uint64_t getSampleCount() const { return samples; }
+
+    Prediction predict(const StrategyParams& params) {
+        if (dirty) fit();
+        std::array<double, FEATURES> phi = features(params);
+
+        double mean = 0;
+        double variance = 0;
+        for (int i = 0; i < FEATURES; ++i) {
+            mean += weights[i] * phi[i];
+            for (int j = 0; j < FEATURES; ++j) {
+                variance += phi[i] * covariance[i * FEATURES + j] * phi[j];
+            }
+        }
+        return {mean, std::sqrt(std::max(0.0, noiseVariance * variance))};
+    }
+
+    void saveState(CheckpointWriter& out) const {
+        out.writeVector(xtx);
+        out.writeVector(xty);
+        out.write(yty);
+        out.write(samples);
+    }
+
+    void loadState(CheckpointReader& in) {
+        xtx = in.readVector<double>();
+        xty = in.readVector<double>();
+        yty = in.read<double>();
+        samples = in.read<uint64_t>();
+        dirty = true;
+    }
+
+private:
+    static std::array<double, FEATURES> features(const StrategyParams& params) {
+        std::vector<double> x = paramsToVector(params);
+        std::array<double, FEATURES> phi{};
+        phi[0] = 1.0;
+        for (int i = 0; i < 7; ++i) {
+            phi[1 + i] = x[i];
+            phi[8 + i] = x[i] * x[i];
+        }
+        return phi;
+    }
+
+    // weights = (X'X + RIDGE I)^-1 X'y via Gauss-Jordan on the 15x15 system;
+    // the inverse is kept as the (noise-scaled) posterior covariance
+    void fit() {
+        const int n = FEATURES;
+        std::vector<double> a(xtx);
+        std::vector<double> inverse(n * n, 0.0);
+        for (int i = 0; i < n; ++i) {
+            a[i * n + i] += RIDGE;
+            inverse[i * n + i] = 1.0;
+        }
+        for (int col = 0; col < n; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < n; ++row) {
+                if (std::abs(a[row * n + col]) > std::abs(a[pivot * n + col])) pivot = row;
+            }
+            for (int k = 0; k < n; ++k) {
+                std::swap(a[col * n + k], a[pivot * n + k]);
+                std::swap(inverse[col * n + k], inverse[pivot * n + k]);
+            }
+            double scale = 1.0 / a[col * n + col];
+            for (int k = 0; k < n; ++k) {
+                a[col * n + k] *= scale;
+                inverse[col * n + k] *= scale;
+            }
+            for (int row = 0; row < n; ++row) {
+                if (row == col) continue;
+                double factor = a[row * n + col];
+                if (factor == 0) continue;
+                for (int k = 0; k < n; ++k) {
+                    a[row * n + k] -= factor * a[col * n + k];
+                    inverse[row * n + k] -= factor * inverse[col * n + k];
+                }
+            }
+        }
+
+        covariance = inverse;
+        weights.assign(n, 0.0);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) weights[i] += covariance[i * n + j] * xty[j];
+        }
+
+        // residual sum of squares from the sufficient statistics
+        double fitted = 0;
+        double explained = 0;
+        for (int i = 0; i < n; ++i) {
+            explained += weights[i] * xty[i];
+            for (int j = 0; j < n; ++j) fitted += weights[i] * xtx[i * n + j] * weights[j];
+        }
+        double residual = std::max(0.0, yty - 2 * explained + fitted);
+        noiseVariance = samples > static_cast<uint64_t>(n) ?
+            residual / static_cast<double>(samples - n) : 1e6;
+        dirty = false;
+    }
+
+    std::vector<double> xtx;
+    std::vector<double> xty;
+    double yty = 0;
+    uint64_t samples = 0;
+
+    bool dirty = true;
+    std::vector<double> weights;
+    std::vector<double> covariance;
+    double noiseVariance = 0;
+};
+
+// Opponent pools for league training. Each side's pool holds the predefined
+// Aggressive, Defensive and Balanced sets plus frozen snapshots of that side's
+// best parameters. Candidates play sampled pool opponents on a fixed set of
+// seeds per opponent, and every (candidate, opponent, seed) outcome is cached
+// by the candidate's exact parameters, so a repeated pairing, e.g. the
+// incumbent meeting the same opponent again, is never re-simulated.
+class League {
+public:
+    static const int SNAPSHOT_INTERVAL = 100; // episodes between snapshots
+    static const int MAX_SNAPSHOTS = 12;      // per side; the oldest is dropped first
+    static const int SEEDS_PER_OPPONENT = 8;
+
+    struct Opponent {
+        uint32_t id;
+        std::string name;
+        std::vector<double> params;
+    };
+
+    League() {
+        for (const auto& [name, params] : getStrategySets()) {
+            if (name != "Aggressive" && name != "Defensive" && name != "Balanced") continue;
+            for (std::vector<Opponent>& pool : pools) {
+                pool.push_back({nextId++, name, paramsToVector(params)});
+            }
+        }
+    }
+
+    // freezes both agents' best parameters every SNAPSHOT_INTERVAL episodes
+    void snapshot(int episode, const std::vector<double>& p1Best, const std::vector<double>& p2Best) {
+        if (episode < nextSnapshotEpisode) return;
+        nextSnapshotEpisode = (episode / SNAPSHOT_INTERVAL + 1) * SNAPSHOT_INTERVAL;
+
+        for (int side = 0; side < 2; ++side) {
+            const std::vector<double>& best = side == 0 ? p1Best : p2Best;
+            std::vector<Opponent>& pool = pools[side];
+            if (pool.back().params == best) continue;
+
+            pool.push_back({nextId++, "P" + std::to_string(side + 1) + "@" + std::to_string(episode),
+                            best});
+            if (pool.size() > FIXED_OPPONENTS + MAX_SNAPSHOTS) {
+                pool.erase(pool.begin() + FIXED_OPPONENTS);
+            }
+        }
+    }
+
+    // Mean reward of each candidate over gamesPerCandidate sampled opponents
+    // from the other side's pool. onGame sees only newly simulated games.
+    std::vector<double> evaluate(
+            const GameExecutor& executor, const std::vector<StrategyParams>& candidates,
+            bool firstPlayer, uint64_t baseSeed, int episode, int gamesPerCandidate,
+            const std::function<void(const GameJob&, const Game::GameResult&)>& onGame) {
+        const std::vector<Opponent>& pool = pools[firstPlayer ? 1 : 0];
+        std::mt19937_64 gen(mixSeed(baseSeed, episode, firstPlayer ? 1 : 2, 0x1EA6));
+        std::uniform_int_distribution<size_t> pickOpponent(0, pool.size() - 1);
+        std::uniform_int_distribution<int> pickSeed(0, SEEDS_PER_OPPONENT - 1);
+
+        std::vector<CacheKey> keys;
+        std::vector<GameJob> jobs;
+        std::vector<CacheKey> jobKeys;
+        for (const StrategyParams& candidate : candidates) {
+            for (int g = 0; g < gamesPerCandidate; ++g) {
+                const Opponent& opponent = pool[pickOpponent(gen)];
+                uint64_t seed = mixSeed(baseSeed, 0x1EA6, opponent.id, pickSeed(gen));
+                CacheKey key{toArray(candidate), opponent.id, seed};
+                keys.push_back(key);
+                lookups++;
+
+                if (cache.count(key) ||
+                    std::find(jobKeys.begin(), jobKeys.end(), key) != jobKeys.end()) {
+                    hits++;
+                    continue;
+                }
+                StrategyParams opponentParams = paramsFromVector(opponent.params);
+                jobs.push_back(firstPlayer ? GameJob{candidate, opponentParams, seed}
+                                           : GameJob{opponentParams, candidate, seed});
+                jobKeys.push_back(key);
+            }
+        }
+
+        std::vector<Game::GameResult> results = executor.run(jobs);
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            cache.emplace(jobKeys[index], results[index]);
+            onGame(jobs[index], results[index]);
+        }
+
+        std::vector<double> rewards(candidates.size(), 0.0);
+        for (size_t k = 0; k < keys.size(); ++k) {
+            rewards[k / gamesPerCandidate] +=
+                computeReward(cache.at(keys[k]), firstPlayer) / gamesPerCandidate;
+        }
+        return rewards;
+    }
+
+    size_t getPoolSize(bool firstPlayer) const { return pools[firstPlayer ? 0 : 1].size(); }
+    uint64_t getLookups() const { return lookups; }
+    uint64_t getHits() const { return hits; }
+
+    // the cache is not saved: it only avoids re-simulating deterministic games
+    void saveState(CheckpointWriter& out) const {
+        out.write(nextId);
+        out.write(nextSnapshotEpisode);
+        for (const std::vector<Opponent>& pool : pools) {
+            out.write(static_cast<uint64_t>(pool.size()));
+            for (const Opponent& opponent : pool) {
+                out.write(opponent.id);
+                out.writeString(opponent.name);
+                out.writeVector(opponent.params);
+            }
+        }
+    }
+
+    void loadState(CheckpointReader& in) {
+        nextId = in.read<uint32_t>();
+        nextSnapshotEpisode = in.read<int>();
+        for (std::vector<Opponent>& pool : pools) {
+            pool.resize(in.read<uint64_t>());
+            for (Opponent& opponent : pool) {
+                opponent.id = in.read<uint32_t>();
+                opponent.name = in.readString();
+                opponent.params = in.readVector<double>();
+            }
+        }
+    }
+
+private:
+    static const size_t FIXED_OPPONENTS = 3;
+
+    struct CacheKey {
+        std::array<double, 7> candidate;
+        uint32_t opponent;
+        uint64_t seed;
+
+        bool operator==(const CacheKey& other) const {
+            return candidate == other.candidate && opponent == other.opponent &&
+                   seed == other.seed;
+        }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const {
+            uint64_t hash = mixSeed(key.seed, key.opponent);
+            for (double value : key.candidate) hash = mixSeed(hash, std::bit_cast<uint64_t>(value));
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    static std::array<double, 7> toArray(const StrategyParams& params) {
+        std::vector<double> values = paramsToVector(params);
+        std::array<double, 7> result;
+        std::copy(values.begin(), values.end(), result.begin());
+        return result;
+    }
+
+    std::vector<Opponent> pools[2]; // player 1 side, player 2 side
+    uint32_t nextId = 0;
+    int nextSnapshotEpisode = 0;
+    std::unordered_map<CacheKey, Game::GameResult, CacheKeyHash> cache;
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+};
+
+struct RaceResult {
+    size_t winner;      // index of the last surviving candidate
+    double meanReward;  // its mean reward over every game it played
+};
+
+// Successive halving over candidates playing a fixed opponent. Every surviving
+// candidate plays the same seeds; after each round the bottom half by mean
+// reward is dropped and the survivors' games are doubled, until one candidate
+// is left. Only the winner is returned: the means of eliminated candidates rest
+// on a few games and would let a lucky early score outrank the winner's
+// long-run mean.
+RaceResult raceCandidates(
+        const GameExecutor& executor, const std::vector<StrategyParams>& candidates,
+        const StrategyParams& opponent, bool firstPlayer, uint64_t seed, int initialGames,
+        const std::function<void(const GameJob&, const Game::GameResult&)>& onGame) {
+    std::vector<double> rewardSums(candidates.size(), 0.0);
+    std::vector<int> played(candidates.size(), 0);
+    std::vector<size_t> alive(candidates.size());
+    for (size_t c = 0; c < alive.size(); ++c) alive[c] = c;
+
+    auto mean = [&](size_t c) { return rewardSums[c] / played[c]; };
+
+    for (int games = std::max(1, initialGames); ; games *= 2) {
+        std::vector<GameJob> jobs;
+        std::vector<size_t> owners;
+        for (size_t c : alive) {
+            for (int g = played[c]; g < games; ++g) {
+                jobs.push_back(firstPlayer ? GameJob{candidates[c], opponent, mixSeed(seed, g)}
+                                           : GameJob{opponent, candidates[c], mixSeed(seed, g)});
+                owners.push_back(c);
+            }
+            played[c] = games;
+        }
+
+        std::vector<Game::GameResult> results = executor.run(jobs);
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            rewardSums[owners[index]] += computeReward(results[index], firstPlayer);
+            onGame(jobs[index], results[index]);
+        }
+
+        std::stable_sort(alive.begin(), alive.end(), [&](size_t a, size_t b) {
+            return mean(a) > mean(b);
+        });
+        alive.resize((alive.size() + 1) / 2);
+        if (alive.size() == 1) break;
+    }
+
+    return {alive[0], mean(alive[0])};
+}
+
+// Unbounded lock-free multi-producer single-consumer queue (Vyukov). Producers
+// only exchange the head pointer, so pushing never waits for the consumer.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node()), tail(head.load()) {}
+
+    ~MpscQueue() {
+        while (tail) {
+            Node* next = tail->next.load();
+            delete tail;
+            tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value.emplace(std::move(value));
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+
+        depth.fetch_add(1, std::memory_order_release);
+        depth.notify_one();
+    }
+
+    // consumer only; empty if nothing has been pushed since the last pop
+    std::optional<T> pop() {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return std::nullopt;
+
+        std::optional<T> value = std::move(next->value);
+        next->value.reset();
+        delete tail;
+        tail = next;
+        depth.fetch_sub(1, std::memory_order_relaxed);
+        return value;
+    }
+
+    // consumer only; returns once at least one element may be available
+    void wait() const {
+        int64_t current = depth.load(std::memory_order_acquire);
+        if (current <= 0) depth.wait(current, std::memory_order_acquire);
+    }
+
+    int64_t size() const { return std::max<int64_t>(0, depth.load(std::memory_order_relaxed)); }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    std::atomic<Node*> head;     // most recently pushed node
+    Node* tail;                  // consumed stub; its successor is the front
+    std::atomic<int64_t> depth{0};
+};
+
+// Asynchronous actor/learner training. Actor threads claim episodes, pull the
+// latest published parameters, play the episode's game and push the outcome
+// into an MPSC queue without ever waiting for the learner. The calling thread
+// is the learner: it drains the queue, updates both agents with everything it
+// drained and publishes the new parameters.
+void runActorLearner(const RunOptions& options, QAgent& p1Agent, QAgent& p2Agent,
+                     uint64_t baseSeed, int startEpisode, int endEpisode,
+                     const std::function<void(const GameJob&, const Game::GameResult&)>& onGame,
+                     const std::function<void(int, int)>& afterEpisodes) {
+    const int LOG_INTERVAL = 50;
+
+    struct Snapshot {
+        uint64_t version;
+        std::vector<double> p1Best;
+        std::vector<double> p2Best;
+        double p1Exploration;
+        double p2Exploration;
+    };
+    struct Experience {
+        GameJob job;
+        Game::GameResult result;
+        uint64_t version; // snapshot the actor chose its parameters from
+    };
+
+    // the lock only guards swapping and copying the pointer, never a game or an update
+    uint64_t version = 0;
+    std::shared_ptr<const Snapshot> latest;
+    std::mutex latestMutex;
+    auto publish = [&]() {
+        auto snapshot = std::make_shared<const Snapshot>(Snapshot{
+            version, p1Agent.getBestParams(), p2Agent.getBestParams(),
+            p1Agent.getExplorationRate(), p2Agent.getExplorationRate()});
+        std::lock_guard<std::mutex> lock(latestMutex);
+        latest.swap(snapshot);
+    };
+    publish();
+
+    MpscQueue<Experience> queue;
+    std::atomic<int> nextEpisode{startEpisode};
+    std::atomic<int64_t> busyNanoseconds{0};
+    auto start = std::chrono::steady_clock::now();
+
+    auto actor = [&](int actorIndex) {
+        std::mt19937 gen(static_cast<uint32_t>(mixSeed(baseSeed, startEpisode, actorIndex, 0xAC7)));
+        for (int episode = nextEpisode++; episode < endEpisode; episode = nextEpisode++) {
+            auto gameStart = std::chrono::steady_clock::now();
+            std::shared_ptr<const Snapshot> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(latestMutex);
+                snapshot = latest;
+            }
+            GameJob job{QAgent::sampleAction(snapshot->p1Best, snapshot->p1Exploration, gen),
+                        QAgent::sampleAction(snapshot->p2Best, snapshot->p2Exploration, gen),
+                        mixSeed(baseSeed, episode, 0)};
+            Game::GameResult result = playGame(job.p1Params, job.p2Params, job.seed, options);
+            queue.push({job, result, snapshot->version});
+            busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - gameStart).count();
+        }
+    };
+
+    int actorCount = std::max(1, options.threads);
+    std::vector<std::thread> actors;
+    for (int a = 0; a < actorCount; ++a) actors.emplace_back(actor, a);
+
+    // pipeline metrics, reset every LOG_INTERVAL episodes
+    int64_t depthSum = 0, maxDepth = 0, drains = 0;
+    uint64_t stalenessSum = 0, maxStaleness = 0, experiences = 0;
+
+    for (int episode = startEpisode; episode < endEpisode; ) {
+        queue.wait();
+        int64_t depth = queue.size();
+        depthSum += depth;
+        maxDepth = std::max(maxDepth, depth);
+        drains++;
+
+        std::vector<std::pair<StrategyParams, double>> p1Samples;
+        std::vector<std::pair<StrategyParams, double>> p2Samples;
+        while (episode + static_cast<int>(p1Samples.size()) < endEpisode) {
+            std::optional<Experience> experience = queue.pop();
+            if (!experience) break;
+
+            onGame(experience->job, experience->result);
+            p1Samples.emplace_back(experience->job.p1Params, computeReward(experience->result, true));
+            p2Samples.emplace_back(experience->job.p2Params, computeReward(experience->result, false));
+
+            uint64_t staleness = version - experience->version;
+            stalenessSum += staleness;
+            maxStaleness = std::max(maxStaleness, staleness);
+            experiences++;
+        }
+        if (p1Samples.empty()) continue;
+
+        p1Agent.updateBatch(p1Samples);
+        p2Agent.updateBatch(p2Samples);
+        for (size_t s = 0; s < p1Samples.size(); ++s) {
+            p1Agent.decay_exploration();
+            p2Agent.decay_exploration();
+        }
+        version++;
+        publish();
+
+        int previousEpisode = episode;
+        episode += static_cast<int>(p1Samples.size());
+        afterEpisodes(previousEpisode, episode);
+
+        if (episode / LOG_INTERVAL != previousEpisode / LOG_INTERVAL || episode == endEpisode) {
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            std::cout << "Pipeline - queue depth avg " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(depthSum) / drains << " (max " << maxDepth
+                      << "), staleness avg " << static_cast<double>(stalenessSum) / experiences
+                      << " updates (max " << maxStaleness << "), actor utilization "
+                      << busyNanoseconds.load() / (seconds * 1e9 * actorCount) * 100 << "%\n";
+            depthSum = maxDepth = drains = 0;
+            stalenessSum = maxStaleness = experiences = 0;
+        }
+    }
+
+    for (std::thread& thread : actors) thread.join();
+}
+
+}  // namespace
+
+void runParameterExperiment(const RunOptions& options) {
+    const int TRAINING_EPISODES = 1000;
+    const int LOG_INTERVAL = 50;
+
+    QAgent p1Agent("Player 1", true, 0.1, 0.95, 0.5);
+    QAgent p2Agent("Player 2", false, 0.1, 0.95, 0.5);
+    p1Agent.setExplorationMode(options.exploration, mixSeed(options.seed, 1, 0, 0x50B0));
+    p2Agent.setExplorationMode(options.exploration, mixSeed(options.seed, 2, 0, 0x50B0));
+
+    int p1WinsInWindow = 0;
+    int p2WinsInWindow = 0;
+    int gamesInWindow = 0;
+    std::vector<double> p1WinRates;
+    std::vector<double> p2WinRates;
+
+    Surrogate p1Surrogate;
+    Surrogate p2Surrogate;
+    int exploredInWindow = 0;
+    int screenedInWindow = 0;
+    League league;
+
+    uint64_t baseSeed = options.seed;
+    int startEpisode = 0;
+    uint64_t resultsSize = 0;
+
+    if (options.surrogate && (options.racing || options.asyncActors)) {
+        throw std::runtime_error("--surrogate cannot be combined with --race or --async");
+    }
+    if (options.league && (options.racing || options.asyncActors || options.paired)) {
+        throw std::runtime_error("--league cannot be combined with --race, --async or --paired");
+    }
+    if (options.exploration == ExplorationMode::SOBOL && options.asyncActors) {
+        // actors sample from snapshots of the best parameters, without the agents' sequences
+        throw std::runtime_error("--exploration sobol cannot be combined with --async");
+    }
+
+    if (options.shouldResume()) {
+        CheckpointReader in(options.checkpointPath, CheckpointKind::TRAINING);
+        baseSeed = in.read<uint64_t>();
+        startEpisode = in.read<int>();
+        p1WinsInWindow = in.read<int>();
+        p2WinsInWindow = in.read<int>();
+        gamesInWindow = in.read<int>();
+        p1WinRates = in.readVector<double>();
+        p2WinRates = in.readVector<double>();
+        resultsSize = in.read<uint64_t>();
+        p1Agent.loadState(in);
+        p2Agent.loadState(in);
+        exploredInWindow = in.read<int>();
+        screenedInWindow = in.read<int>();
+        p1Surrogate.loadState(in);
+        p2Surrogate.loadState(in);
+        league.loadState(in);
+        std::cout << "Resuming training from " << options.checkpointPath
+                  << " at episode " << startEpisode << "\n";
+    } else if (options.surrogate) {
+        for (const std::string& path : options.surrogatePaths) {
+            if (path == options.resultsPath) {
+                throw std::runtime_error(path + " would be overwritten by --results");
+            }
+            p1Surrogate.addResultFile(path, true);
+            p2Surrogate.addResultFile(path, false);
+        }
+        std::cout << "Surrogate warmed up with " << p1Surrogate.getSampleCount()
+                  << " games\n";
+    }
+
+    std::unique_ptr<ResultWriter> writer;
+    if (!options.resultsPath.empty()) {
+        writer = std::make_unique<ResultWriter>(options.resultsPath, std::vector<std::string>{},
+                                                0, options.seed, resultsSize);
+    }
+
+    auto saveCheckpoint = [&](int nextEpisode) {
+        if (writer) writer->flush();
+
+        CheckpointWriter out(options.checkpointPath, CheckpointKind::TRAINING);
+        out.write(baseSeed);
+        out.write(nextEpisode);
+        out.write(p1WinsInWindow);
+        out.write(p2WinsInWindow);
+        out.write(gamesInWindow);
+        out.writeVector(p1WinRates);
+        out.writeVector(p2WinRates);
+        out.write(writer ? writer->getWrittenSize() : uint64_t{0});
+        p1Agent.saveState(out);
+        p2Agent.saveState(out);
+        out.write(exploredInWindow);
+        out.write(screenedInWindow);
+        p1Surrogate.saveState(out);
+        p2Surrogate.saveState(out);
+        league.saveState(out);
+        out.commit();
+    };
+
+    GameExecutor executor(options);
+    int population = options.racing && options.population == 1 ? 16 : std::max(1, options.population);
+    int gamesPerCandidate = std::max(1, options.gamesPerCandidate);
+
+    // logs and checkpoints after the episodes [previousEpisode, episode) are done
+    auto finishEpisodes = [&](int previousEpisode, int episode) {
+        if (episode / LOG_INTERVAL != previousEpisode / LOG_INTERVAL) {
+            double p1WinRate = static_cast<double>(p1WinsInWindow) / gamesInWindow;
+            double p2WinRate = static_cast<double>(p2WinsInWindow) / gamesInWindow;
+
+            p1WinRates.push_back(p1WinRate);
+            p2WinRates.push_back(p2WinRate);
+
+            std::cout << "\n========== Episode " << episode << "/"
+                     << TRAINING_EPISODES << " ==========\n";
+            std::cout << "Exploration Rates - P1: " << std::fixed
+                     << std::setprecision(3) << p1Agent.getExplorationRate()
+                     << ", P2: " << p2Agent.getExplorationRate() << "\n";
+            std::cout << "Recent Win Rates - P1: " << (p1WinRate * 100)
+                     << "%, P2: " << (p2WinRate * 100) << "%\n";
+
+            p1Agent.printBestParameters();
+            p2Agent.printBestParameters();
+
+            if (options.league) {
+                std::cout << "League - pool P1: " << league.getPoolSize(true) << ", P2: "
+                          << league.getPoolSize(false) << " opponents, "
+                          << league.getHits() << " of " << league.getLookups()
+                          << " evaluation games answered from the cache\n";
+            }
+            if (options.surrogate) {
+                std::cout << "Surrogate - " << p1Surrogate.getSampleCount()
+                          << " samples, rejected " << screenedInWindow << " of "
+                          << exploredInWindow << " explored candidates without simulating\n";
+            }
+
+            p1WinsInWindow = 0;
+            p2WinsInWindow = 0;
+            gamesInWindow = 0;
+            exploredInWindow = 0;
+            screenedInWindow = 0;
+        }
+
+        if (!options.checkpointPath.empty() &&
+            (episode / options.checkpointInterval != previousEpisode / options.checkpointInterval ||
+             episode == TRAINING_EPISODES)) {
+            saveCheckpoint(episode);
+        }
+    };
+
+    auto recordGame = [&](const GameJob& job, const Game::GameResult& result) {
+        if (writer) {
+            writer->append(GameRecord{job.seed, UNNAMED_STRATEGY, UNNAMED_STRATEGY,
+                                      job.p1Params, job.p2Params, result});
+        }
+        if (result.winner == 1) p1WinsInWindow++;
+        else if (result.winner == 2) p2WinsInWindow++;
+        gamesInWindow++;
+
+        if (options.surrogate) {
+            p1Surrogate.add(job.p1Params, computeReward(result, true));
+            p2Surrogate.add(job.p2Params, computeReward(result, false));
+        }
+    };
+
+    // The agent's next action. With a surrogate, an explored candidate whose
+    // predicted upper bound does not beat the incumbent's predicted reward is
+    // redrawn without being simulated; after MAX_SCREEN_ATTEMPTS the incumbent
+    // is played instead.
+    auto nextAction = [&](QAgent& agent, Surrogate& surrogate) {
+        const int MAX_SCREEN_ATTEMPTS = 20;
+
+        StrategyParams action = agent.getAction();
+        if (!options.surrogate || !surrogate.isReady() ||
+            paramsToVector(action) == agent.getBestParams()) {
+            return action;
+        }
+
+        exploredInWindow++;
+        double incumbentReward = surrogate.predict(paramsFromVector(agent.getBestParams())).mean;
+        for (int attempt = 0; attempt < MAX_SCREEN_ATTEMPTS; ++attempt) {
+            if (surrogate.predict(action).upperBound() > incumbentReward) return action;
+            screenedInWindow++;
+            action = agent.explore();
+        }
+        return paramsFromVector(agent.getBestParams());
+    };
+
+    std::cout << "Starting RL training for " << TRAINING_EPISODES << " episodes\n";
+    if (options.asyncActors) {
+        std::cout << "Asynchronous training: " << options.threads
+                  << " actor threads and a learner thread\n";
+    } else if (options.league) {
+        std::cout << "League: " << population << " candidates per generation, each against "
+                  << gamesPerCandidate << " pool opponents, " << executor.getThreadCount()
+                  << " threads\n";
+    } else if (options.racing) {
+        std::cout << "Racing: " << population << " candidates per generation, "
+                  << gamesPerCandidate << " games each in the first round, "
+                  << executor.getThreadCount() << " threads\n";
+    } else if (population > 1 || gamesPerCandidate > 1) {
+        std::cout << "Batched training: " << population << " candidates per generation, "
+                  << gamesPerCandidate << " games each, " << executor.getThreadCount()
+                  << " threads\n";
+    }
+
+    if (options.asyncActors) {
+        runActorLearner(options, p1Agent, p2Agent, baseSeed, startEpisode, TRAINING_EPISODES,
+                        recordGame, finishEpisodes);
+    } else {
+        // Every episode evaluates one candidate per agent: candidate c of player 1
+        // plays candidate c of player 2. A generation plays `population` episodes
+        // at once and updates both agents with all of their rewards.
+        for (int episode = startEpisode; episode < TRAINING_EPISODES; ) {
+            int candidates = std::min(population, TRAINING_EPISODES - episode);
+
+            StrategyParams p1Best = paramsFromVector(p1Agent.getBestParams());
+            StrategyParams p2Best = paramsFromVector(p2Agent.getBestParams());
+            std::vector<std::pair<StrategyParams, double>> p1Samples;
+            std::vector<std::pair<StrategyParams, double>> p2Samples;
+
+            if (options.racing) {
+                // Each agent races its incumbent and candidates-1 perturbations of
+                // it against the other agent's incumbent.
+                std::vector<StrategyParams> p1Candidates{p1Best};
+                std::vector<StrategyParams> p2Candidates{p2Best};
+                for (int c = 1; c < candidates; ++c) {
+                    p1Candidates.push_back(p1Agent.explore());
+                    p2Candidates.push_back(p2Agent.explore());
+                }
+
+                RaceResult p1Race = raceCandidates(
+                    executor, p1Candidates, p2Best, true, mixSeed(baseSeed, episode, 1),
+                    gamesPerCandidate, recordGame);
+                RaceResult p2Race = raceCandidates(
+                    executor, p2Candidates, p1Best, false, mixSeed(baseSeed, episode, 2),
+                    gamesPerCandidate, recordGame);
+
+                // the agent sees only the race winner, scored by its mean over all
+                // the games it survived to play
+                p1Samples.emplace_back(p1Candidates[p1Race.winner], p1Race.meanReward);
+                p2Samples.emplace_back(p2Candidates[p2Race.winner], p2Race.meanReward);
+            } else if (options.league) {
+                // candidates play sampled opponents of the other side's pool
+                league.snapshot(episode, p1Agent.getBestParams(), p2Agent.getBestParams());
+
+                std::vector<StrategyParams> p1Candidates;
+                std::vector<StrategyParams> p2Candidates;
+                for (int c = 0; c < candidates; ++c) {
+                    p1Candidates.push_back(nextAction(p1Agent, p1Surrogate));
+                    p2Candidates.push_back(nextAction(p2Agent, p2Surrogate));
+                }
+
+                std::vector<double> p1Rewards = league.evaluate(
+                    executor, p1Candidates, true, baseSeed, episode, gamesPerCandidate, recordGame);
+                std::vector<double> p2Rewards = league.evaluate(
+                    executor, p2Candidates, false, baseSeed, episode, gamesPerCandidate, recordGame);
+
+                for (int c = 0; c < candidates; ++c) {
+                    p1Samples.emplace_back(p1Candidates[c], p1Rewards[c]);
+                    p2Samples.emplace_back(p2Candidates[c], p2Rewards[c]);
+                }
+            } else {
+                // In paired mode every seed is also played by both incumbents, and a
+                // candidate is scored by its reward difference to the incumbent on the
+                // same placements (common random numbers). A candidate that is the
+                // incumbent reuses the baseline game.
+                std::vector<StrategyParams> p1Candidates;
+                std::vector<StrategyParams> p2Candidates;
+                std::vector<GameJob> jobs;
+                std::vector<size_t> p1Games;       // per (candidate, game)
+                std::vector<size_t> p2Games;
+                std::vector<size_t> baselineGames;
+                auto addJob = [&](const StrategyParams& p1, const StrategyParams& p2, uint64_t seed) {
+                    jobs.push_back({p1, p2, seed});
+                    return jobs.size() - 1;
+                };
+                for (int c = 0; c < candidates; ++c) {
+                    p1Candidates.push_back(nextAction(p1Agent, p1Surrogate));
+                    p2Candidates.push_back(nextAction(p2Agent, p2Surrogate));
+                    bool p1Incumbent = paramsToVector(p1Candidates[c]) == p1Agent.getBestParams();
+                    bool p2Incumbent = paramsToVector(p2Candidates[c]) == p2Agent.getBestParams();
+
+                    for (int g = 0; g < gamesPerCandidate; ++g) {
+                        uint64_t seed = mixSeed(baseSeed, episode + c, g);
+                        if (!options.paired) {
+                            size_t game = addJob(p1Candidates[c], p2Candidates[c], seed);
+                            p1Games.push_back(game);
+                            p2Games.push_back(game);
+                            continue;
+                        }
+                        size_t baseline = addJob(p1Best, p2Best, seed);
+                        baselineGames.push_back(baseline);
+                        p1Games.push_back(p1Incumbent ? baseline : addJob(p1Candidates[c], p2Best, seed));
+                        p2Games.push_back(p2Incumbent ? baseline : addJob(p1Best, p2Candidates[c], seed));
+                    }
+                }
+
+                std::vector<Game::GameResult> results = executor.run(jobs);
+
+                for (size_t index = 0; index < jobs.size(); ++index) {
+                    recordGame(jobs[index], results[index]);
+                }
+
+                for (int c = 0; c < candidates; ++c) {
+                    double p1Reward = 0;
+                    double p2Reward = 0;
+                    for (int g = 0; g < gamesPerCandidate; ++g) {
+                        size_t index = c * gamesPerCandidate + g;
+                        p1Reward += computeReward(results[p1Games[index]], true);
+                        p2Reward += computeReward(results[p2Games[index]], false);
+                        if (options.paired) {
+                            p1Reward -= computeReward(results[baselineGames[index]], true);
+                            p2Reward -= computeReward(results[baselineGames[index]], false);
+                        }
+                    }
+                    p1Reward /= gamesPerCandidate;
+                    p2Reward /= gamesPerCandidate;
+                    if (options.paired) {
+                        // the incumbent's value plus the candidate's paired advantage
+                        p1Reward += p1Agent.getBestQValue();
+                        p2Reward += p2Agent.getBestQValue();
+                    }
+                    p1Samples.emplace_back(p1Candidates[c], p1Reward);
+                    p2Samples.emplace_back(p2Candidates[c], p2Reward);
+                }
+            }
+
+            p1Agent.updateBatch(p1Samples);
+            p2Agent.updateBatch(p2Samples);
+
+            for (int c = 0; c < candidates; ++c) {
+                p1Agent.decay_exploration();
+                p2Agent.decay_exploration();
+            }
+
+            int previousEpisode = episode;
+            episode += candidates;
+            finishEpisodes(previousEpisode, episode);
+        }
+    }
+
+    if (writer) writer->flush();
+
+    std::cout << "\n===== Training Complete =====\n";
+    std::cout << "\nFinal Parameters:\n";
+    p1Agent.printBestParameters();
+    p2Agent.printBestParameters();
+}
+
+namespace {
+
+// CMA-ES (covariance matrix adaptation evolution strategy) over the 7
+// StrategyParams weights, maximizing reward. Each generation samples
+// populationSize candidates around the mean; the ranked candidates move the
+// mean and adapt the step size and covariance, so noisy single rewards are
+// averaged out instead of being kept as the best-ever value.
+class CmaEs {
+public:
+    static const int N = 7;
+
+    CmaEs(const std::vector<double>& initialMean, double initialSigma,
+          int populationSize, uint64_t seed)
+        : lambda(std::max(4, populationSize)), mean(initialMean), sigma(initialSigma),
+          pc(N, 0.0), ps(N, 0.0), C(N * N, 0.0), B(N * N, 0.0), D(N, 1.0),
+          generation(0), rng(seed) {
+        mu = lambda / 2;
+        double weightSum = 0;
+        for (int i = 0; i < mu; ++i) {
+            weights.push_back(std::log(mu + 0.5) - std::log(i + 1.0));
+            weightSum += weights.back();
+        }
+        double squareSum = 0;
+        for (double& w : weights) {
+            w /= weightSum;
+            squareSum += w * w;
+        }
+        mueff = 1.0 / squareSum;
+
+        cc = (4.0 + mueff / N) / (N + 4.0 + 2.0 * mueff / N);
+        cs = (mueff + 2.0) / (N + mueff + 5.0);
+        c1 = 2.0 / ((N + 1.3) * (N + 1.3) + mueff);
+        cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) /
+                                     ((N + 2.0) * (N + 2.0) + mueff));
+        damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (N + 1.0)) - 1.0) + cs;
+        chiN = std::sqrt(static_cast<double>(N)) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+
+        for (int i = 0; i < N; ++i) {
+            C[i * N + i] = 1.0;
+            B[i * N + i] = 1.0;
+        }
+    }
+
+    std::vector<std::vector<double>> ask() {
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::vector<std::vector<double>> candidates(lambda, std::vector<double>(N));
+        for (std::vector<double>& x : candidates) {
+            std::vector<double> z(N);
+            for (double& v : z) v = normal(rng);
+            for (int i = 0; i < N; ++i) {
+                double offset = 0;
+                for (int j = 0; j < N; ++j) offset += B[i * N + j] * D[j] * z[j];
+                x[i] = mean[i] + sigma * offset;
+            }
+        }
+        return candidates;
+    }
+
+    void tell(const std::vector<std::vector<double>>& candidates,
+              const std::vector<double>& rewards) {
+        std::vector<int> order(candidates.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+        std::sort(order.begin(), order.end(),
+                  [&](int a, int b) { return rewards[a] > rewards[b]; });
+
+        std::vector<double> oldMean = mean;
+        for (int i = 0; i < N; ++i) {
+            mean[i] = 0;
+            for (int k = 0; k < mu; ++k) mean[i] += weights[k] * candidates[order[k]][i];
+        }
+
+        std::vector<double> step(N);
+        for (int i = 0; i < N; ++i) step[i] = (mean[i] - oldMean[i]) / sigma;
+
+        // ps follows C^-1/2 * step = B * D^-1 * B^T * step
+        std::vector<double> whitened(N, 0.0);
+        for (int j = 0; j < N; ++j) {
+            double projection = 0;
+            for (int i = 0; i < N; ++i) projection += B[i * N + j] * step[i];
+            projection /= D[j];
+            for (int i = 0; i < N; ++i) whitened[i] += B[i * N + j] * projection;
+        }
+
+        double psNorm = 0;
+        for (int i = 0; i < N; ++i) {
+            ps[i] = (1 - cs) * ps[i] + std::sqrt(cs * (2 - cs) * mueff) * whitened[i];
+            psNorm += ps[i] * ps[i];
+        }
+        psNorm = std::sqrt(psNorm);
+
+        ++generation;
+        bool hsig = psNorm / std::sqrt(1 - std::pow(1 - cs, 2.0 * generation)) / chiN <
+                    1.4 + 2.0 / (N + 1);
+        for (int i = 0; i < N; ++i) {
+            pc[i] = (1 - cc) * pc[i] + (hsig ? std::sqrt(cc * (2 - cc) * mueff) * step[i] : 0.0);
+        }
+
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j <= i; ++j) {
+                double rankMu = 0;
+                for (int k = 0; k < mu; ++k) {
+                    const std::vector<double>& x = candidates[order[k]];
+                    rankMu += weights[k] * ((x[i] - oldMean[i]) / sigma) *
+                              ((x[j] - oldMean[j]) / sigma);
+                }
+                double value = (1 - c1 - cmu) * C[i * N + j] +
+                               c1 * (pc[i] * pc[j] +
+                                     (hsig ? 0.0 : cc * (2 - cc) * C[i * N + j])) +
+                               cmu * rankMu;
+                C[i * N + j] = value;
+                C[j * N + i] = value;
+            }
+        }
+
+        sigma *= std::exp((cs / damps) * (psNorm / chiN - 1));
+        sigma = std::clamp(sigma, 1e-4, 10.0);
+        updateEigensystem();
+    }
+
+    const std::vector<double>& getMean() const { return mean; }
+    double getSigma() const { return sigma; }
+    int getPopulationSize() const { return lambda; }
+    int getGeneration() const { return generation; }
+
+    void saveState(CheckpointWriter& out) const {
+        out.writeVector(mean);
+        out.write(sigma);
+        out.writeVector(pc);
+        out.writeVector(ps);
+        out.writeVector(C);
+        out.write(generation);
+
+        std::ostringstream rngState;
+        rngState << rng;
+        out.writeString(rngState.str());
+    }
+
+    void loadState(CheckpointReader& in) {
+        mean = in.readVector<double>();
+        sigma = in.read<double>();
+        pc = in.readVector<double>();
+        ps = in.readVector<double>();
+        C = in.readVector<double>();
+        generation = in.read<int>();
+
+        std::istringstream rngState(in.readString());
+        rngState >> rng;
+        updateEigensystem();
+    }
+
+private:
+    int lambda;
+    int mu;
+    std::vector<double> weights;
+    double mueff, cc, cs, c1, cmu, damps, chiN;
+
+    std::vector<double> mean;
+    double sigma;
+    std::vector<double> pc;
+    std::vector<double> ps;
+    std::vector<double> C; // covariance, row-major N x N
+    std::vector<double> B; // eigenvectors of C in columns
+    std::vector<double> D; // square roots of the eigenvalues of C
+    int generation;
+    std::mt19937_64 rng;
+
+    // cyclic Jacobi rotations; cheap and robust for a 7x7 symmetric matrix
+    void updateEigensystem() {
+        std::vector<double> a = C;
+        std::fill(B.begin(), B.end(), 0.0);
+        for (int i = 0; i < N; ++i) B[i * N + i] = 1.0;
+
+        for (int sweep = 0; sweep < 50; ++sweep) {
+            double offDiagonal = 0;
+            for (int p = 0; p < N; ++p) {
+                for (int q = p + 1; q < N; ++q) offDiagonal += a[p * N + q] * a[p * N + q];
+            }
+            if (offDiagonal < 1e-20) break;
+
+            for (int p = 0; p < N; ++p) {
+                for (int q = p + 1; q < N; ++q) {
+                    if (std::abs(a[p * N + q]) < 1e-300) continue;
+                    double theta = (a[q * N + q] - a[p * N + p]) / (2 * a[p * N + q]);
+                    double t = (theta >= 0 ? 1.0 : -1.0) /
+                               (std::abs(theta) + std::sqrt(theta * theta + 1));
+                    double c = 1 / std::sqrt(t * t + 1);
+                    double s = t * c;
+
+                    for (int k = 0; k < N; ++k) {
+                        double akp = a[k * N + p];
+                        double akq = a[k * N + q];
+                        a[k * N + p] = c * akp - s * akq;
+                        a[k * N + q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < N; ++k) {
+                        double apk = a[p * N + k];
+                        double aqk = a[q * N + k];
+                        a[p * N + k] = c * apk - s * aqk;
+                        a[q * N + k] = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < N; ++k) {
+                        double bkp = B[k * N + p];
+                        double bkq = B[k * N + q];
+                        B[k * N + p] = c * bkp - s * bkq;
+                        B[k * N + q] = s * bkp + c * bkq;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < N; ++i) D[i] = std::sqrt(std::max(a[i * N + i], 1e-20));
+    }
+};
+
+void printParameterVector(const std::string& title, const std::vector<double>& params) {
+    std::cout << "\n" << title << ":\n";
+    std::cout << "Health Weight: " << std::fixed << std::setprecision(3)
+             << params[0] << "\n";
+    std::cout << "Missile Weight: " << params[1] << "\n";
+    std::cout << "Block Weight: " << params[2] << "\n";
+    std::cout << "Target Weight: " << params[3] << "\n";
+    std::cout << "Enemy Distance Weight: " << params[4] << "\n";
+    std::cout << "Ally Distance Weight: " << params[5] << "\n";
+    std::cout << "Attack Threshold: " << params[6] << "\n";
+}
+
+}  // namespace
+
+// CMA-ES counterpart of runParameterExperiment: both players' parameters are
+// optimized against the other player's current mean, one generation at a time.
+void runCmaEsTraining(const RunOptions& options) {
+    const int TRAINING_EPISODES = 1000;
+    const int LOG_INTERVAL = 50;
+
+    int populationSize = options.population > 1 ? options.population : 9;
+    int gamesPerCandidate = std::max(1, options.gamesPerCandidate);
+    CmaEs p1Optimizer(paramsToVector(StrategyParams(true)), 0.5, populationSize,
+                      mixSeed(options.seed, 1));
+    CmaEs p2Optimizer(paramsToVector(StrategyParams(false)), 0.5, populationSize,
+                      mixSeed(options.seed, 2));
+
+    uint64_t baseSeed = options.seed;
+    int startEpisode = 0;
+    uint64_t resultsSize = 0;
+    double p1RewardInWindow = 0;
+    double p2RewardInWindow = 0;
+    int candidatesInWindow = 0;
+
+    if (options.shouldResume()) {
+        CheckpointReader in(options.checkpointPath, CheckpointKind::CMAES_TRAINING);
+        baseSeed = in.read<uint64_t>();
+        startEpisode = in.read<int>();
+        p1RewardInWindow = in.read<double>();
+        p2RewardInWindow = in.read<double>();
+        candidatesInWindow = in.read<int>();
+        resultsSize = in.read<uint64_t>();
+        p1Optimizer.loadState(in);
+        p2Optimizer.loadState(in);
+        std::cout << "Resuming CMA-ES training from " << options.checkpointPath
+                  << " at episode " << startEpisode << "\n";
+    }
+
+    std::unique_ptr<ResultWriter> writer;
+    if (!options.resultsPath.empty()) {
+        writer = std::make_unique<ResultWriter>(options.resultsPath, std::vector<std::string>{},
+                                                0, options.seed, resultsSize);
+    }
+
+    GameExecutor executor(options);
+    int lambda = p1Optimizer.getPopulationSize();
+    std::cout << "Starting CMA-ES training for " << TRAINING_EPISODES
+              << " candidate evaluations per player (population " << lambda << ", "
+              << gamesPerCandidate << " games each, " << executor.getThreadCount()
+              << " threads)\n";
+
+    // an episode is one candidate evaluation per player
+    for (int episode = startEpisode; episode < TRAINING_EPISODES; ) {
+        StrategyParams p1Mean = paramsFromVector(p1Optimizer.getMean());
+        StrategyParams p2Mean = paramsFromVector(p2Optimizer.getMean());
+        std::vector<std::vector<double>> p1Candidates = p1Optimizer.ask();
+        std::vector<std::vector<double>> p2Candidates = p2Optimizer.ask();
+
+        // player 1 candidates first, then player 2 candidates
+        std::vector<GameJob> jobs;
+        for (int c = 0; c < lambda; ++c) {
+            for (int g = 0; g < gamesPerCandidate; ++g) {
+                jobs.push_back({paramsFromVector(p1Candidates[c]), p2Mean,
+                                mixSeed(baseSeed, episode + c, g, 1)});
+            }
+        }
+        for (int c = 0; c < lambda; ++c) {
+            for (int g = 0; g < gamesPerCandidate; ++g) {
+                jobs.push_back({p1Mean, paramsFromVector(p2Candidates[c]),
+                                mixSeed(baseSeed, episode + c, g, 2)});
+            }
+        }
+
+        std::vector<Game::GameResult> results = executor.run(jobs);
+
+        std::vector<double> p1Rewards(lambda, 0.0);
+        std::vector<double> p2Rewards(lambda, 0.0);
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            bool p1Candidate = index < jobs.size() / 2;
+            size_t c = (p1Candidate ? index : index - jobs.size() / 2) / gamesPerCandidate;
+            if (p1Candidate) p1Rewards[c] += computeReward(results[index], true) / gamesPerCandidate;
+            else p2Rewards[c] += computeReward(results[index], false) / gamesPerCandidate;
+
+            if (writer) {
+                writer->append(GameRecord{jobs[index].seed, UNNAMED_STRATEGY, UNNAMED_STRATEGY,
+                                          jobs[index].p1Params, jobs[index].p2Params,
+                                          results[index]});
+            }
+        }
+
+        p1Optimizer.tell(p1Candidates, p1Rewards);
+        p2Optimizer.tell(p2Candidates, p2Rewards);
+
+        for (int c = 0; c < lambda; ++c) {
+            p1RewardInWindow += p1Rewards[c];
+            p2RewardInWindow += p2Rewards[c];
+        }
+        candidatesInWindow += lambda;
+
+        int previousEpisode = episode;
+        episode = std::min(episode + lambda, TRAINING_EPISODES);
+
+        if (episode / LOG_INTERVAL != previousEpisode / LOG_INTERVAL ||
+            episode == TRAINING_EPISODES) {
+            std::cout << "\n========== Episode " << episode << "/"
+                     << TRAINING_EPISODES << " (generation " << p1Optimizer.getGeneration()
+                     << ") ==========\n";
+            std::cout << "Step Sizes - P1: " << std::fixed << std::setprecision(3)
+                     << p1Optimizer.getSigma() << ", P2: " << p2Optimizer.getSigma() << "\n";
+            std::cout << "Mean Candidate Reward - P1: " << std::setprecision(1)
+                     << p1RewardInWindow / candidatesInWindow << ", P2: "
+                     << p2RewardInWindow / candidatesInWindow << "\n";
+            printParameterVector("Player 1 Mean Parameters", p1Optimizer.getMean());
+            printParameterVector("Player 2 Mean Parameters", p2Optimizer.getMean());
+
+            p1RewardInWindow = 0;
+            p2RewardInWindow = 0;
+            candidatesInWindow = 0;
+        }
+
+        if (!options.checkpointPath.empty() &&
+            (episode / options.checkpointInterval != previousEpisode / options.checkpointInterval ||
+             episode == TRAINING_EPISODES)) {
+            if (writer) writer->flush();
+
+            CheckpointWriter out(options.checkpointPath, CheckpointKind::CMAES_TRAINING);
+            out.write(baseSeed);
+            out.write(episode);
+            out.write(p1RewardInWindow);
+            out.write(p2RewardInWindow);
+            out.write(candidatesInWindow);
+            out.write(writer ? writer->getWrittenSize() : uint64_t{0});
+            p1Optimizer.saveState(out);
+            p2Optimizer.saveState(out);
+            out.commit();
+        }
+    }
+
+    if (writer) writer->flush();
+
+    std::cout << "\n===== Training Complete =====\n";
+    printParameterVector("Player 1 Mean Parameters", p1Optimizer.getMean());
+    printParameterVector("Player 2 Mean Parameters", p2Optimizer.getMean());
+}
+
+std::vector<std::pair<std::string, StrategyParams>> getStrategySets() {
+    return {
+         {"Aggressive", StrategyParams(-1.0, 1.0, 0.8, -0.5, 0.5, -0.5,0)}, // relative less block and  target weight
+         {"Defensive", StrategyParams(-1.0, 1.0, 1.2, -1.5, 0.5, -0.5,2)}, // relative high block and target weight
+        {"Balanced", StrategyParams(-1.0, 1.0, 1.0, -1.0, 0.5, -0.5,1)},  // normal
+        {"RL_Player2", StrategyParams( -1.583,   1.054, 1.130,  -1.348, -0.641,  -0.301, 0.108)}, // defensive
+        {"RL_Player1", StrategyParams(-0.955, 0.655, 0.288, -1.263, 0.074, -0.530,-0.175)},// counter
+        {"RL_Player1_v2", StrategyParams(-1.896,-1.594, 0.790, 1.110, 0.478, 1.598,1.772)},
+        {"RL_Player2_v2", StrategyParams(-1.685, 0.782, 0.741, -1.793, -0.753, -0.492, 0.482)}
+
+    };
+}
+
+namespace {
+
+struct DetailedStats {
+    int wins = 0;
+    int totalShips = 0;
+    int totalHealth = 0;
+    int totalRounds = 0;
+    double totalDuration = 0.0;
+
+    int totalMissilesUsed = 0;
+    int totalDamageDealt = 0;
+    int survivalRounds = 0;
+};
+
+struct ExperimentResult {
+    DetailedStats p1Stats;
+    DetailedStats p2Stats;
+    int draws = 0;
+    int games = 0;
+    double phaseSeconds[TIMED_PHASE_COUNT] = {};
+};
+
+// results[i][j] holds strategy i as player 1 against strategy j as player 2
+using MatchupGrid = std::vector<std::vector<ExperimentResult>>;
+
+void accumulateResult(ExperimentResult& res, const Game::GameResult& result) {
+    res.games++;
+    for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+        res.phaseSeconds[phase] += result.phaseSeconds[phase];
+    }
+
+    res.p1Stats.totalShips += result.p1Ships;
+    res.p1Stats.totalHealth += result.p1Health;
+    res.p1Stats.totalRounds += result.rounds;
+    res.p1Stats.totalDuration += result.duration;
+
+    res.p2Stats.totalShips += result.p2Ships;
+    res.p2Stats.totalHealth += result.p2Health;
+    res.p2Stats.totalRounds += result.rounds;
+    res.p2Stats.totalDuration += result.duration;
+
+    if (result.winner == 1) {
+        res.p1Stats.wins++;
+    } else if (result.winner == 2) {
+        res.p2Stats.wins++;
+    } else {
+        res.draws++;
+    }
+}
+
+// rebuilds the tournament grid from a results file without re-simulating
+MatchupGrid aggregateResults(const ResultFile& file) {
+    size_t strategyCount = file.getStrategyNames().size();
+    MatchupGrid results(strategyCount, std::vector<ExperimentResult>(strategyCount));
+
+    for (const ResultFile::Block& block : file.getBlocks()) {
+        for (size_t row = 0; row < block.rows; ++row) {
+            uint16_t i = block.get<uint16_t>(COL_P1_STRATEGY, row);
+            uint16_t j = block.get<uint16_t>(COL_P2_STRATEGY, row);
+            if (i >= strategyCount || j >= strategyCount) continue;
+
+            accumulateResult(results[i][j], block.getResult(row));
+        }
+    }
+    return results;
+}
+
+// Strategy comparison on common random numbers. In a paired tournament every
+// matchup replays the same placement seeds, so for each seed and opponent the
+// mean score of strategy A over both sides can be differenced with that of
+// strategy B on exactly the same placements. Placement luck cancels out of
+// the difference instead of adding to its variance.
+class PairedComparison {
+public:
+    struct Outcome {
+        uint64_t seed;
+        uint16_t p1;
+        uint16_t p2;
+        int8_t score; // +1 player 1 won, -1 player 2 won, 0 draw
+    };
+
+    explicit PairedComparison(size_t strategyCount) : strategyCount(strategyCount) {}
+
+    void add(uint16_t p1, uint16_t p2, uint64_t seed, uint8_t winner) {
+        if (p1 >= strategyCount || p2 >= strategyCount) return;
+        outcomes.push_back({seed, p1, p2, static_cast<int8_t>(winner == 1 ? 1 : winner == 2 ? -1 : 0)});
+    }
+
+    // prints nothing unless some seeds were played by several matchups
+    void print(const std::vector<std::string>& names) {
+        struct PairStats {
+            int units = 0;
+            double sumA = 0, sumA2 = 0;
+            double sumB = 0, sumB2 = 0;
+            double sumD = 0, sumD2 = 0;
+        };
+        const int8_t MISSING = -2;
+        size_t n = strategyCount;
+        std::vector<PairStats> pairs(n * n);
+        std::vector<int8_t> grid(n * n);
+
+        std::sort(outcomes.begin(), outcomes.end(), [](const Outcome& a, const Outcome& b) {
+            return a.seed < b.seed;
+        });
+
+        int totalUnits = 0;
+        for (size_t first = 0; first < outcomes.size(); ) {
+            size_t last = first;
+            std::fill(grid.begin(), grid.end(), MISSING);
+            for (; last < outcomes.size() && outcomes[last].seed == outcomes[first].seed; ++last) {
+                grid[outcomes[last].p1 * n + outcomes[last].p2] = outcomes[last].score;
+            }
+            first = last;
+
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = i + 1; j < n; ++j) {
+                    for (size_t o = 0; o < n; ++o) {
+                        if (o == i || o == j) continue;
+                        if (grid[i * n + o] == MISSING || grid[o * n + i] == MISSING ||
+                            grid[j * n + o] == MISSING || grid[o * n + j] == MISSING) continue;
+
+                        // mean score over both sides; as player 2 the score flips sign
+                        double a = (grid[i * n + o] - grid[o * n + i]) / 2.0;
+                        double b = (grid[j * n + o] - grid[o * n + j]) / 2.0;
+                        PairStats& s = pairs[i * n + j];
+                        s.units++;
+                        s.sumA += a; s.sumA2 += a * a;
+                        s.sumB += b; s.sumB2 += b * b;
+                        s.sumD += a - b; s.sumD2 += (a - b) * (a - b);
+                        totalUnits++;
+                    }
+                }
+            }
+        }
+        if (totalUnits == 0) return;
+
+        auto variance = [](double sum, double sum2, int count) {
+            return count > 1 ? std::max(0.0, (sum2 - sum * sum / count) / (count - 1)) : 0.0;
+        };
+
+        std::cout << "\n===== Paired Comparison (common random numbers) =====\n";
+        std::cout << "Score difference A - B per seed and opponent, both sides played "
+                  << "(+1 = A always wins, -1 = B always wins)\n\n";
+        std::cout << std::left << std::setw(16) << "Strategy A" << std::setw(16) << "Strategy B"
+                  << std::right << std::setw(7) << "Units" << std::setw(10) << "Diff"
+                  << std::setw(10) << "95% CI" << std::setw(14) << "Games saved\n";
+
+        double logReductionSum = 0;
+        int reductionCount = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                const PairStats& s = pairs[i * n + j];
+                if (s.units == 0) continue;
+
+                double paired = variance(s.sumD, s.sumD2, s.units);
+                double unpaired = variance(s.sumA, s.sumA2, s.units) +
+                                  variance(s.sumB, s.sumB2, s.units);
+                std::cout << std::left << std::setw(16) << names[i] << std::setw(16) << names[j]
+                          << std::right << std::setw(7) << s.units << std::fixed
+                          << std::setprecision(3) << std::setw(10) << s.sumD / s.units
+                          << std::setw(10) << 1.96 * std::sqrt(paired / s.units);
+                // independent placements for A and B would need this many times the games
+                if (paired > 0 && unpaired > 0) {
+                    std::cout << std::setw(12) << std::setprecision(1) << unpaired / paired << "x\n";
+                    logReductionSum += std::log(unpaired / paired);
+                    reductionCount++;
+                } else {
+                    std::cout << std::setw(13) << "-" << "\n";
+                }
+            }
+        }
+        if (reductionCount > 0) {
+            std::cout << "\nUnpaired evaluation would need " << std::setprecision(1)
+                      << std::exp(logReductionSum / reductionCount)
+                      << "x the games on average (geometric mean) for the same confidence\n";
+        }
+    }
+
+    void saveState(CheckpointWriter& out) const { out.writeVector(outcomes); }
+    void loadState(CheckpointReader& in) { outcomes = in.readVector<Outcome>(); }
+
+private:
+    size_t strategyCount;
+    std::vector<Outcome> outcomes;
+};
+
+// Where the tournament's simulation time went, summed over all games.
+void printPhaseTiming(const MatchupGrid& results) {
+    double phaseSeconds[TIMED_PHASE_COUNT] = {};
+    double totalSeconds = 0;
+    int games = 0;
+    for (const auto& row : results) {
+        for (const ExperimentResult& res : row) {
+            games += res.games;
+            for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+                phaseSeconds[phase] += res.phaseSeconds[phase];
+                totalSeconds += res.phaseSeconds[phase];
+            }
+        }
+    }
+    if (games == 0 || totalSeconds == 0) return;
+
+    std::cout << "\nPhase Timing (" << games << " games):\n";
+    std::cout << "==========================\n";
+    for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+        std::cout << "  " << std::left << std::setw(18) << PHASE_NAMES[phase + 1] << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(10) << phaseSeconds[phase]
+                  << " s  " << std::setprecision(1) << std::setw(5)
+                  << phaseSeconds[phase] / totalSeconds * 100 << "%  "
+                  << std::setprecision(3) << std::setw(9) << phaseSeconds[phase] / games * 1e3
+                  << " ms/game\n";
+    }
+}
+
+void printStrategyReport(const std::vector<std::string>& names, const MatchupGrid& results) {
+    std::cout << "\nOverall Strategy Analysis:\n";
+    std::cout << "========================\n\n";
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::cout << "\nStrategy: " << names[i] << "\n";
+        std::cout << "--------------------------------\n";
+
+        int totalP1Games = 0;
+        int totalP1Wins = 0;
+        double avgP1Ships = 0;
+        double avgP1Health = 0;
+
+        int totalP2Games = 0;
+        int totalP2Wins = 0;
+        double avgP2Ships = 0;
+        double avgP2Health = 0;
+
+        for (size_t j = 0; j < names.size(); ++j) {
+
+            totalP1Games += results[i][j].games;
+            totalP1Wins += results[i][j].p1Stats.wins;
+            avgP1Ships += results[i][j].p1Stats.totalShips;
+            avgP1Health += results[i][j].p1Stats.totalHealth;
+
+            totalP2Games += results[j][i].games;
+            totalP2Wins += results[j][i].p2Stats.wins;
+            avgP2Ships += results[j][i].p2Stats.totalShips;
+            avgP2Health += results[j][i].p2Stats.totalHealth;
+        }
+        totalP1Games = std::max(1, totalP1Games);
+        totalP2Games = std::max(1, totalP2Games);
+
+        std::cout << "As Player 1:\n";
+        std::cout << "  Win Rate: " << std::fixed << std::setprecision(1)
+                  << (static_cast<double>(totalP1Wins) / totalP1Games * 100) << "%\n";
+        std::cout << "  Average Ships Remaining: "
+                  << (avgP1Ships / totalP1Games) << "\n";
+        std::cout << "  Average Health Remaining: "
+                  << (avgP1Health / totalP1Games) << "\n";
+
+        std::cout << "As Player 2:\n";
+        std::cout << "  Win Rate: " << std::fixed << std::setprecision(1)
+                  << (static_cast<double>(totalP2Wins) / totalP2Games * 100) << "%\n";
+        std::cout << "  Average Ships Remaining: "
+                  << (avgP2Ships / totalP2Games) << "\n";
+        std::cout << "  Average Health Remaining: "
+                  << (avgP2Health / totalP2Games) << "\n";
+    }
+
+    std::cout << "\nDetailed Matchup Statistics:\n";
+    std::cout << "==========================\n\n";
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        for (size_t j = 0; j < names.size(); ++j) {
+
+            const auto& res = results[i][j];
+            if (res.games == 0) continue;
+            int totalGames = res.games;
+
+            std::cout << "\nMatchup: " << names[i]
+                     << "(P1) vs " << names[j] << "(P2)\n";
+            std::cout << "----------------------------------------\n";
+
+            // Player 1
+            std::cout << "Player 1 (" << names[i] << "):\n";
+            std::cout << "  Wins: " << res.p1Stats.wins << " ("
+                     << std::fixed << std::setprecision(1)
+                     << (static_cast<double>(res.p1Stats.wins) / totalGames * 100)
+                     << "%)\n";
+            std::cout << "  Average Ships: "
+                     << static_cast<double>(res.p1Stats.totalShips) / totalGames
+                     << "\n";
+            std::cout << "  Average Health: "
+                     << static_cast<double>(res.p1Stats.totalHealth) / totalGames
+                     << "\n";
+
+            // player 2
+            std::cout << "Player 2 (" << names[j] << "):\n";
+            std::cout << "  Wins: " << res.p2Stats.wins << " ("
+                     << std::fixed << std::setprecision(1)
+                     << (static_cast<double>(res.p2Stats.wins) / totalGames * 100)
+                     << "%)\n";
+            std::cout << "  Average Ships: "
+                     << static_cast<double>(res.p2Stats.totalShips) / totalGames
+                     << "\n";
+            std::cout << "  Average Health: "
+                     << static_cast<double>(res.p2Stats.totalHealth) / totalGames
+                     << "\n";
+
+            // overall
+            std::cout << "Match Statistics:\n";
+            std::cout << "  Draws: " << res.draws << " ("
+                     << (static_cast<double>(res.draws) / totalGames * 100)
+                     << "%)\n";
+            std::cout << "  Average rounds: "
+                     << static_cast<double>(res.p1Stats.totalRounds) / totalGames
+                     << "\n";
+            std::cout << "  Average duration: "
+                     << res.p1Stats.totalDuration / totalGames
+                     << " seconds\n";
+        }
+    }
+
+    printPhaseTiming(results);
+}
+
+// writes <prefix>win_rate.csv, <prefix>draw_rate.csv and <prefix>lose_rate.csv,
+// the P1-vs-P2 matrices behind the published charts (see plot_rates.py)
+void exportRateTables(const std::vector<std::string>& names, const MatchupGrid& results,
+                      const std::string& prefix) {
+    const char* tables[] = {"win_rate", "draw_rate", "lose_rate"};
+
+    for (int t = 0; t < 3; ++t) {
+        std::string path = prefix + tables[t] + ".csv";
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("cannot write " + path);
+        }
+
+        out << "P1\\P2";
+        for (const std::string& name : names) out << "," << name;
+        out << "\n";
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            out << names[i];
+            for (size_t j = 0; j < names.size(); ++j) {
+                const ExperimentResult& res = results[i][j];
+                int count = t == 0 ? res.p1Stats.wins : t == 1 ? res.draws : res.p2Stats.wins;
+                out << "," << std::fixed << std::setprecision(3)
+                    << (res.games > 0 ? static_cast<double>(count) / res.games : 0.0);
+            }
+            out << "\n";
+        }
+        std::cout << "Wrote " << path << "\n";
+    }
+}
+
+std::vector<std::string> getStrategyNames(
+    const std::vector<std::pair<std::string, StrategyParams>>& paramSets) {
+    std::vector<std::string> names;
+    for (const auto& [name, params] : paramSets) names.push_back(name);
+    return names;
+}
+
+#ifdef TBS_WORK_COUNTERS
+// Work per game and per round of each player, allocations per round of each
+// phase and per call of each ALLOCATION_SCOPE, over the games this run played.
+void printWorkCounters(const std::array<WorkCounters, 2>& totals,
+                       const std::array<AllocationCounts, TIMED_PHASE_COUNT>& phaseTotals,
+                       uint64_t games, uint64_t rounds) {
+    if (games == 0) return;
+
+    std::cout << "\nWork Counters (" << games << " games, " << rounds << " rounds):\n";
+    std::cout << "==========================\n";
+    std::cout << "  " << std::left << std::setw(20) << "" << std::right
+              << std::setw(14) << "P1/game" << std::setw(14) << "P2/game"
+              << std::setw(12) << "P1/round" << std::setw(12) << "P2/round" << "\n";
+    auto row = [&](const char* name, uint64_t WorkCounters::*field) {
+        std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed
+                  << std::setprecision(1)
+                  << std::setw(14) << static_cast<double>(totals[0].*field) / games
+                  << std::setw(14) << static_cast<double>(totals[1].*field) / games
+                  << std::setw(12) << static_cast<double>(totals[0].*field) / std::max<uint64_t>(1, rounds)
+                  << std::setw(12) << static_cast<double>(totals[1].*field) / std::max<uint64_t>(1, rounds)
+                  << "\n";
+    };
+    row("targets evaluated", &WorkCounters::targetsEvaluated);
+    row("ray tests", &WorkCounters::rayTests);
+    row("reachable cells", &WorkCounters::reachableCells);
+    row("moves scored", &WorkCounters::movesScored);
+    row("heap allocations", &WorkCounters::allocations);
+    row("allocated bytes", &WorkCounters::allocatedBytes);
+    row("attacks issued", &WorkCounters::attacksIssued);
+    row("attacks triggered", &WorkCounters::attacksTriggered);
+
+    std::cout << "\n  " << std::left << std::setw(20) << "phase" << std::right
+              << std::setw(14) << "allocs/round" << std::setw(14) << "bytes/round" << "\n";
+    for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+        std::cout << "  " << std::left << std::setw(20) << PHASE_NAMES[phase + 1] << std::right
+                  << std::setw(14) << static_cast<double>(phaseTotals[phase].allocations) / std::max<uint64_t>(1, rounds)
+                  << std::setw(14) << static_cast<double>(phaseTotals[phase].bytes) / std::max<uint64_t>(1, rounds)
+                  << "\n";
+    }
+
+    std::cout << "\n  " << std::left << std::setw(30) << "scope (process totals)" << std::right
+              << std::setw(14) << "calls" << std::setw(14) << "allocs/call" << std::setw(14)
+              << "bytes/call" << "\n";
+    for (AllocationSite* site = AllocationSite::head.load(); site; site = site->next) {
+        uint64_t calls = site->calls.load();
+        std::cout << "  " << std::left << std::setw(30) << site->name << std::right
+                  << std::setw(14) << calls
+                  << std::setw(14) << static_cast<double>(site->allocations.load()) / std::max<uint64_t>(1, calls)
+                  << std::setw(14) << static_cast<double>(site->bytes.load()) / std::max<uint64_t>(1, calls)
+                  << "\n";
+    }
+}
+#endif
+
+}  // namespace
+
+void runDifferentStrategy(const RunOptions& options) {
+    const int EXPERIMENT_ROUNDS = 20;
+    std::vector<std::pair<std::string, StrategyParams>> paramSets = getStrategySets();
+    std::vector<std::string> names = getStrategyNames(paramSets);
+    size_t strategyCount = paramSets.size();
+
+    MatchupGrid results(strategyCount, std::vector<ExperimentResult>(strategyCount));
+    PairedComparison paired(strategyCount);
+
+    // games are numbered (i * strategyCount + j) * EXPERIMENT_ROUNDS + k
+    size_t totalGames = strategyCount * strategyCount * EXPERIMENT_ROUNDS;
+    size_t nextGame = 0;
+    uint64_t baseSeed = options.seed;
+    uint64_t resultsSize = 0;
+
+    if (options.shouldResume()) {
+        CheckpointReader in(options.checkpointPath, CheckpointKind::TOURNAMENT);
+        if (in.read<int>() != options.shardIndex || in.read<int>() != options.shardCount) {
+            throw std::runtime_error(options.checkpointPath + " belongs to a different shard");
+        }
+        if (in.read<bool>() != options.paired) {
+            throw std::runtime_error(options.checkpointPath +
+                                     " was written with a different --paired setting");
+        }
+        baseSeed = in.read<uint64_t>();
+        nextGame = in.read<uint64_t>();
+        resultsSize = in.read<uint64_t>();
+        paired.loadState(in);
+        std::vector<ExperimentResult> cells = in.readVector<ExperimentResult>();
+        if (cells.size() != strategyCount * strategyCount) {
+            throw std::runtime_error(options.checkpointPath +
+                                     " was written for a different strategy set");
+        }
+        for (size_t c = 0; c < cells.size(); ++c) {
+            results[c / strategyCount][c % strategyCount] = cells[c];
+        }
+        std::cout << "Resuming tournament from " << options.checkpointPath
+                  << " at game " << nextGame << "/" << totalGames << "\n";
+    }
+
+    std::unique_ptr<ResultWriter> writer;
+    if (!options.resultsPath.empty()) {
+        writer = std::make_unique<ResultWriter>(options.resultsPath, names,
+                                                EXPERIMENT_ROUNDS, baseSeed, resultsSize);
+    }
+
+    auto saveCheckpoint = [&](size_t completedGames) {
+        if (writer) writer->flush();
+
+        std::vector<ExperimentResult> cells;
+        for (const auto& row : results) cells.insert(cells.end(), row.begin(), row.end());
+
+        CheckpointWriter out(options.checkpointPath, CheckpointKind::TOURNAMENT);
+        out.write(options.shardIndex);
+        out.write(options.shardCount);
+        out.write(options.paired);
+        out.write(baseSeed);
+        out.write(static_cast<uint64_t>(completedGames));
+        out.write(writer ? writer->getWrittenSize() : uint64_t{0});
+        paired.saveState(out);
+        out.writeVector(cells);
+        out.commit();
+    };
+
+    if (options.shardCount > 1) {
+        std::cout << "Playing shard " << options.shardIndex << "/" << options.shardCount
+                  << " of " << totalGames << " games\n";
+    }
+
+    // Games are played in batches on the executor; a batch ends at every
+    // checkpoint so a checkpoint always covers complete batches.
+    GameExecutor executor(options);
+    size_t batchSize = options.checkpointPath.empty() ?
+        static_cast<size_t>(executor.getThreadCount()) * 4 :
+        static_cast<size_t>(options.checkpointInterval);
+
+    std::vector<size_t> batch;
+    size_t lastMatchup = SIZE_MAX;
+#ifdef TBS_WORK_COUNTERS
+    std::array<WorkCounters, 2> workTotals{};
+    std::array<AllocationCounts, TIMED_PHASE_COUNT> phaseAllocationTotals{};
+    uint64_t playedGames = 0, playedRounds = 0;
+#endif
+
+    auto playBatch = [&]() {
+        if (batch.empty()) return;
+
+        std::vector<GameJob> jobs;
+        for (size_t game : batch) {
+            size_t i = game / (strategyCount * EXPERIMENT_ROUNDS);
+            size_t j = (game / EXPERIMENT_ROUNDS) % strategyCount;
+            size_t k = game % EXPERIMENT_ROUNDS;
+
+            if (game / EXPERIMENT_ROUNDS != lastMatchup) {
+                lastMatchup = game / EXPERIMENT_ROUNDS;
+                std::cout << "Testing P1:" << paramSets[i].first << " vs P2:"
+                         << paramSets[j].first << "...\n";
+            }
+            // paired games replay the same placements in every matchup
+            uint64_t seed = options.paired ? mixSeed(baseSeed, k) : mixSeed(baseSeed, i, j, k);
+            std::ostringstream replayName;
+            replayName << std::hex << std::setw(16) << std::setfill('0') << seed << '-'
+                       << paramSets[i].first << "-vs-" << paramSets[j].first;
+            jobs.push_back({paramSets[i].second, paramSets[j].second, seed, GameConfig(),
+                            replayName.str()});
+        }
+
+        std::vector<Game::GameResult> batchResults = executor.run(jobs);
+
+        for (size_t b = 0; b < batch.size(); ++b) {
+            size_t i = batch[b] / (strategyCount * EXPERIMENT_ROUNDS);
+            size_t j = (batch[b] / EXPERIMENT_ROUNDS) % strategyCount;
+
+            accumulateResult(results[i][j], batchResults[b]);
+#ifdef TBS_WORK_COUNTERS
+            workTotals[0] += batchResults[b].work[0];
+            workTotals[1] += batchResults[b].work[1];
+            for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+                phaseAllocationTotals[phase] += batchResults[b].phaseAllocations[phase];
+            }
+            ++playedGames;
+            playedRounds += batchResults[b].rounds;
+#endif
+            if (options.paired) {
+                paired.add(static_cast<uint16_t>(i), static_cast<uint16_t>(j), jobs[b].seed,
+                           static_cast<uint8_t>(batchResults[b].winner));
+            }
+            if (writer) {
+                writer->append(GameRecord{jobs[b].seed, static_cast<uint16_t>(i),
+                                          static_cast<uint16_t>(j),
+                                          paramSets[i].second, paramSets[j].second,
+                                          batchResults[b]});
+            }
+        }
+
+        if (!options.checkpointPath.empty()) saveCheckpoint(batch.back() + 1);
+        batch.clear();
+    };
+
+    for (size_t game = nextGame; game < totalGames; ++game) {
+        // round-robin assignment keeps every shard's mix of matchups (and run time) even
+        if (game % options.shardCount != static_cast<size_t>(options.shardIndex)) continue;
+
+        batch.push_back(game);
+        if (batch.size() == batchSize) playBatch();
+    }
+    playBatch();
+    if (!options.checkpointPath.empty()) saveCheckpoint(totalGames);
+    if (writer) writer->flush();
+
+    printStrategyReport(names, results);
+    paired.print(names);
+#ifdef TBS_WORK_COUNTERS
+    printWorkCounters(workTotals, phaseAllocationTotals, playedGames, playedRounds);
+#endif
+}
+
+void runResultReport(const std::string& path, const std::string& ratesPrefix) {
+    auto start = std::chrono::high_resolution_clock::now();
+    ResultFile file(path);
+    MatchupGrid results = aggregateResults(file);
+    double seconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Loaded " << file.getRowCount() << " games from " << path
+              << " in " << std::fixed << std::setprecision(3) << seconds << " seconds\n";
+
+    printStrategyReport(file.getStrategyNames(), results);
+    if (!ratesPrefix.empty()) {
+        exportRateTables(file.getStrategyNames(), results, ratesPrefix);
+    }
+
+    PairedComparison paired(file.getStrategyNames().size());
+    for (const ResultFile::Block& block : file.getBlocks()) {
+        for (size_t row = 0; row < block.rows; ++row) {
+            paired.add(block.get<uint16_t>(COL_P1_STRATEGY, row),
+                       block.get<uint16_t>(COL_P2_STRATEGY, row),
+                       block.get<uint64_t>(COL_SEED, row),
+                       block.get<uint8_t>(COL_WINNER, row));
+        }
+    }
+    paired.print(file.getStrategyNames());
+}
+
+// combines the results files of a sharded tournament into one report
+void runShardMerge(const std::vector<std::string>& paths, const std::string& ratesPrefix) {
+    if (paths.empty()) {
+        throw std::runtime_error("--merge expects at least one results file");
+    }
+
+    std::vector<std::string> names;
+    uint32_t gamesPerMatchup = 0;
+    std::optional<uint64_t> baseSeed;
+    MatchupGrid results;
+    std::unique_ptr<PairedComparison> paired;
+    std::unordered_set<uint64_t> seenGames; // (matchup, seed) is unique per tournament game
+    size_t duplicates = 0;
+
+    for (const std::string& path : paths) {
+        ResultFile file(path);
+        if (names.empty()) {
+            names = file.getStrategyNames();
+            gamesPerMatchup = file.getGamesPerMatchup();
+            baseSeed = file.getBaseSeed();
+            results.assign(names.size(), std::vector<ExperimentResult>(names.size()));
+            paired = std::make_unique<PairedComparison>(names.size());
+        } else if (file.getStrategyNames() != names ||
+                   file.getGamesPerMatchup() != gamesPerMatchup) {
+            throw std::runtime_error(path + " was produced by a different tournament");
+        } else if (file.getBaseSeed() != baseSeed) {
+            // shards of different seeds play different games under the same (matchup, index)
+            throw std::runtime_error(path + " was produced with a different --seed");
+        }
+        std::cout << "Merging " << path << " (" << file.getRowCount() << " games)\n";
+
+        for (const ResultFile::Block& block : file.getBlocks()) {
+            for (size_t row = 0; row < block.rows; ++row) {
+                GameRecord record = ResultFile::getRecord(block, row);
+                uint16_t i = record.p1Strategy;
+                uint16_t j = record.p2Strategy;
+                if (i >= names.size() || j >= names.size()) continue;
+
+                // the same shard copied back twice must not be counted twice
+                if (!seenGames.insert(mixSeed(record.seed, i, j)).second) {
+                    ++duplicates;
+                    continue;
+                }
+                accumulateResult(results[i][j], record.result);
+                paired->add(i, j, record.seed, record.result.winner);
+            }
+        }
+    }
+
+    if (duplicates > 0) {
+        std::cout << "Skipped " << duplicates << " duplicate games\n";
+    }
+    size_t missing = 0;
+    size_t overfull = 0; // matchups with more games than the tournament plays
+    for (const auto& row : results) {
+        for (const ExperimentResult& res : row) {
+            if (res.games < static_cast<int>(gamesPerMatchup)) {
+                missing += gamesPerMatchup - res.games;
+            } else if (res.games > static_cast<int>(gamesPerMatchup)) {
+                ++overfull;
+            }
+        }
+    }
+    if (missing > 0) {
+        std::cout << "Warning: " << missing << " games are missing, "
+                  << "the report covers only the shards given\n";
+    }
+    if (overfull > 0) {
+        std::cout << "Warning: " << overfull << " matchups have more than "
+                  << gamesPerMatchup << " games, the shards do not come from one tournament\n";
+    }
+
+    printStrategyReport(names, results);
+    if (!ratesPrefix.empty()) {
+        exportRateTables(names, results, ratesPrefix);
+    }
+    paired->print(names);
+}
+
+StrategyParams findStrategy(const std::string& name) {
+    for (const auto& [strategyName, params] : getStrategySets()) {
+        if (strategyName == name) return params;
+    }
+    throw std::runtime_error("unknown strategy " + name);
+}
+
+namespace {
+
+// Win rate of player 1 parameters against a fixed player 2 opponent on a fixed
+// set of evaluation seeds (disjoint from any training seed).
+double evaluateWinRate(const GameExecutor& executor, const StrategyParams& params,
+                       const StrategyParams& opponent, uint64_t baseSeed, int games) {
+    std::vector<GameJob> jobs;
+    for (int e = 0; e < games; ++e) {
+        jobs.push_back({params, opponent, mixSeed(baseSeed, 0xE7A1, e)});
+    }
+    int wins = 0;
+    for (const Game::GameResult& result : executor.run(jobs)) {
+        if (result.winner == 1) ++wins;
+    }
+    return static_cast<double>(wins) / games;
+}
+
+}  // namespace
+
+// Optimizes player 1 parameters against a fixed opponent with the QAgent hill
+// climber (uniform and Sobol exploration) and CMA-ES, and reports how many
+// training games each needed to reach the target win rate on the evaluation seeds.
+void runOptimizerComparison(const RunOptions& options) {
+    StrategyParams opponent = findStrategy(options.opponent);
+    GameExecutor executor(options);
+    int lambda = options.population > 1 ? options.population : 9;
+    int gamesPerCandidate = std::max(1, options.gamesPerCandidate);
+
+    std::cout << "Optimizer comparison against " << options.opponent << " (P2): budget "
+              << options.budget << " training games, target win rate "
+              << std::fixed << std::setprecision(1) << options.targetWinRate * 100
+              << "% over " << options.evalGames << " evaluation games\n";
+
+    struct Trace {
+        std::string name;
+        std::vector<std::pair<int, double>> points; // (training games, eval win rate)
+    };
+    std::vector<Trace> traces;
+
+    // the current agent: one game per episode, best params re-evaluated every lambda games;
+    // both exploration modes share the agent seed and the training game seeds; the
+    // explore/exploit choices still diverge, as uniform perturbation draws from the
+    // same generator and Sobol perturbation does not
+    for (ExplorationMode mode : {ExplorationMode::UNIFORM, ExplorationMode::SOBOL}) {
+        bool sobol = mode == ExplorationMode::SOBOL;
+        Trace trace{sobol ? "QAgent Sobol" : "QAgent hill climbing", {}};
+        QAgent agent("QAgent", true, 0.1, 0.95, 0.5);
+        agent.setVerbose(false);
+        agent.seedRandom(mixSeed(options.seed, 4));
+        agent.setExplorationMode(mode, mixSeed(options.seed, 5));
+        for (int games = 0; games < options.budget; ) {
+            for (int e = 0; e < lambda && games < options.budget; ++e, ++games) {
+                StrategyParams params = agent.getAction();
+                auto result = playGame(params, opponent, mixSeed(options.seed, games, 0, 1), options);
+                agent.update(params, computeReward(result, true));
+                agent.decay_exploration();
+            }
+            double winRate = evaluateWinRate(executor, paramsFromVector(agent.getBestParams()),
+                                             opponent, options.seed, options.evalGames);
+            trace.points.emplace_back(games, winRate);
+            std::cout << (sobol ? "  Sobol     games " : "  QAgent    games ")
+                      << std::setw(5) << games << ": win rate "
+                      << std::setprecision(1) << winRate * 100 << "%\n";
+            if (winRate >= options.targetWinRate) break;
+        }
+        traces.push_back(trace);
+    }
+
+    {
+        Trace trace{"CMA-ES", {}};
+        CmaEs optimizer(paramsToVector(StrategyParams(true)), 0.5, lambda, mixSeed(options.seed, 3));
+        for (int games = 0; games + lambda * gamesPerCandidate <= options.budget; ) {
+            std::vector<std::vector<double>> candidates = optimizer.ask();
+            std::vector<GameJob> jobs;
+            for (int c = 0; c < lambda; ++c) {
+                for (int g = 0; g < gamesPerCandidate; ++g) {
+                    jobs.push_back({paramsFromVector(candidates[c]), opponent,
+                                    mixSeed(options.seed, games + c * gamesPerCandidate + g, 0, 2)});
+                }
+            }
+            std::vector<Game::GameResult> results = executor.run(jobs);
+            games += static_cast<int>(jobs.size());
+
+            std::vector<double> rewards(lambda, 0.0);
+            for (size_t index = 0; index < jobs.size(); ++index) {
+                rewards[index / gamesPerCandidate] +=
+                    computeReward(results[index], true) / gamesPerCandidate;
+            }
+            optimizer.tell(candidates, rewards);
+
+            double winRate = evaluateWinRate(executor, paramsFromVector(optimizer.getMean()),
+                                             opponent, options.seed, options.evalGames);
+            trace.points.emplace_back(games, winRate);
+            std::cout << "  CMA-ES    games " << std::setw(5) << games << ": win rate "
+                      << std::setprecision(1) << winRate * 100 << "%\n";
+            if (winRate >= options.targetWinRate) break;
+        }
+        traces.push_back(trace);
+    }
+
+    std::cout << "\nGames needed to reach " << std::setprecision(1)
+              << options.targetWinRate * 100 << "% win rate:\n";
+    for (const Trace& trace : traces) {
+        std::cout << "  " << std::left << std::setw(22) << trace.name << std::right;
+        auto reached = std::find_if(trace.points.begin(), trace.points.end(),
+                                    [&](const auto& point) {
+                                        return point.second >= options.targetWinRate;
+                                    });
+        if (reached != trace.points.end()) {
+            std::cout << reached->first << " games\n";
+        } else {
+            double best = 0;
+            for (const auto& point : trace.points) best = std::max(best, point.second);
+            std::cout << "not reached within " << options.budget << " games (best "
+                      << best * 100 << "%)\n";
+        }
+    }
+}
+
+namespace {
+
+// What one sweep point measured. Plain data, so a child process can send it
+// back through a pipe.
+struct SweepMeasurement {
+    uint64_t games = 0;
+    uint64_t rounds = 0;
+    double wallSeconds = 0;
+    double gameSeconds = 0;
+    std::array<double, TIMED_PHASE_COUNT> phaseSeconds{};
+    int64_t peakResidentKilobytes = -1; // -1 if not measured
+    int64_t peakHeapBytes = -1;         // -1 without TBS_WORK_COUNTERS
+};
+
+SweepMeasurement measureSweepPoint(const GameExecutor& executor, const std::vector<GameJob>& jobs) {
+    SweepMeasurement measurement;
+#ifdef TBS_WORK_COUNTERS
+    resetPeakHeapBytes();
+#endif
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Game::GameResult> results = executor.run(jobs);
+    measurement.wallSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    measurement.games = results.size();
+    for (const Game::GameResult& result : results) {
+        measurement.rounds += result.rounds;
+        measurement.gameSeconds += result.duration;
+        for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+            measurement.phaseSeconds[phase] += result.phaseSeconds[phase];
+        }
+    }
+#ifdef TBS_WORK_COUNTERS
+    measurement.peakHeapBytes = peakHeapBytes.load();
+#endif
+    return measurement;
+}
+
+// Measures a sweep point in a forked child process, so that the peak resident
+// set size of the child covers this point alone: heap kept by the allocator
+// after an earlier, larger point cannot show up in a later row. Without
+// fork() the point runs in process and its peak RSS is left unmeasured.
+// So does every point while --trace records: a child's events would never
+// reach the trace file, and forking while the tracer's flusher thread may hold
+// its mutex could deadlock the child.
+SweepMeasurement measureSweepPointIsolated(const GameExecutor& executor,
+                                           const std::vector<GameJob>& jobs) {
+#ifdef _WIN32
+    return measureSweepPoint(executor, jobs);
+#else
+    if (Tracer::enabled()) return measureSweepPoint(executor, jobs);
+
+    int fds[2];
+    if (pipe(fds) != 0) throw std::runtime_error("cannot create a pipe for a sweep point");
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) throw std::runtime_error("cannot fork a sweep point");
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 1;
+        try {
+            SweepMeasurement measurement = measureSweepPoint(executor, jobs);
+            rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+                measurement.peakResidentKilobytes = usage.ru_maxrss / 1024;
+#else
+                measurement.peakResidentKilobytes = usage.ru_maxrss;
+#endif
+            }
+            if (write(fds[1], &measurement, sizeof(measurement)) ==
+                static_cast<ssize_t>(sizeof(measurement))) {
+                status = 0;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Sweep point failed: " << e.what() << "\n";
+        }
+        _exit(status);
+    }
+
+    close(fds[1]);
+    SweepMeasurement measurement;
+    size_t received = 0;
+    while (received < sizeof(measurement)) {
+        ssize_t n = read(fds[0], reinterpret_cast<char*>(&measurement) + received,
+                         sizeof(measurement) - received);
+        if (n <= 0) break;
+        received += static_cast<size_t>(n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (received != sizeof(measurement) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("sweep point process failed");
+    }
+    return measurement;
+#endif
+}
+
+// Least-squares fit of log(y) = c + sum_k b_k log(x_k); returns the exponents b_k.
+std::vector<double> fitPowerLaw(const std::vector<std::vector<double>>& xs,
+                                const std::vector<double>& ys) {
+    size_t n = xs.empty() ? 0 : xs[0].size() + 1;
+    std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+    for (size_t r = 0; r < ys.size(); ++r) {
+        std::vector<double> row{1.0};
+        for (double x : xs[r]) row.push_back(std::log(x));
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) a[i][j] += row[i] * row[j];
+            a[i][n] += row[i] * std::log(ys[r]);
+        }
+    }
+    // Gauss-Jordan elimination with partial pivoting on the normal equations
+    for (size_t c = 0; c < n; ++c) {
+        size_t pivot = c;
+        for (size_t r = c + 1; r < n; ++r) {
+            if (std::abs(a[r][c]) > std::abs(a[pivot][c])) pivot = r;
+        }
+        std::swap(a[c], a[pivot]);
+        if (std::abs(a[c][c]) < EPSILON) throw std::runtime_error("scaling fit is singular");
+        for (size_t r = 0; r < n; ++r) {
+            if (r == c) continue;
+            double factor = a[r][c] / a[c][c];
+            for (size_t k = c; k <= n; ++k) a[r][k] -= factor * a[c][k];
+        }
+    }
+    std::vector<double> exponents;
+    for (size_t i = 1; i < n; ++i) exponents.push_back(a[i][n] / a[i][i]);
+    return exponents;
+}
+
+}  // namespace
+
+// Plays --sweep-games seeded games (--p1 vs --p2, capped at --sweep-rounds
+// rounds) at every point of the map size x fleet scale x move range grid,
+// writes one CSV row per point and fits how the cost of a round scales with
+// each dimension that the grid varies.
+void runScalabilitySweep(const std::string& path, const std::string& p1Name,
+                         const std::string& p2Name, const RunOptions& options) {
+    StrategyParams p1 = findStrategy(p1Name);
+    StrategyParams p2 = findStrategy(p2Name);
+    GameExecutor executor(options);
+
+    std::ofstream csv(path, std::ios::trunc);
+    if (!csv) throw std::runtime_error("cannot open sweep file " + path);
+    csv << "map_size,ships,mean_move_range,games,rounds,games_per_sec,ms_per_round";
+    for (int phase = 1; phase <= TIMED_PHASE_COUNT; ++phase) {
+        std::string name = PHASE_NAMES[phase];
+        std::replace(name.begin(), name.end(), ' ', '_');
+        csv << "," << name << "_ms_per_round";
+    }
+    csv << ",peak_rss_kb,peak_heap_bytes\n";
+
+    std::cout << "Scalability sweep: " << p1Name << "(P1) vs " << p2Name << "(P2), "
+              << options.sweepGames << " games of at most " << options.sweepRounds
+              << " rounds per point\n";
+
+    // the standard fleets: 17 ships with move ranges summing to 53
+    const int BASE_SHIPS = 17;
+    const double BASE_MEAN_RANGE = 53.0 / BASE_SHIPS;
+
+    std::vector<std::vector<double>> points; // map size, ships, mean move range
+    std::vector<double> secondsPerRound;
+    for (int mapSize : options.sweepMapSizes) {
+        for (int fleetScale : options.sweepFleetScales) {
+            for (int rangeBonus : options.sweepRangeBonuses) {
+                GameConfig config;
+                config.mapSize = mapSize;
+                config.maxRounds = options.sweepRounds;
+                config.fleetScale = fleetScale;
+                config.moveRangeBonus = rangeBonus;
+
+                // random placement keeps ships two cells apart in the third of the map on
+                // each side; leave it at least twice the area the fleet blocks
+                int ships = BASE_SHIPS * fleetScale;
+                if (mapSize < 6 || (mapSize / 3) * mapSize < 2 * 9 * ships) {
+                    throw std::runtime_error("a " + std::to_string(mapSize) + " map cannot hold " +
+                                             std::to_string(ships) + " ships");
+                }
+
+                std::vector<GameJob> jobs;
+                for (int g = 0; g < options.sweepGames; ++g) {
+                    jobs.push_back({p1, p2, mixSeed(options.seed, g), config});
+                }
+                SweepMeasurement point = measureSweepPointIsolated(executor, jobs);
+
+                uint64_t rounds = std::max<uint64_t>(1, point.rounds);
+                double gamesPerSecond = point.games / point.wallSeconds;
+                double meanRange = BASE_MEAN_RANGE + rangeBonus;
+                points.push_back({static_cast<double>(mapSize), static_cast<double>(ships), meanRange});
+                secondsPerRound.push_back(point.gameSeconds / rounds);
+
+                csv << mapSize << "," << ships << "," << meanRange << "," << point.games << ","
+                    << rounds << "," << gamesPerSecond << "," << point.gameSeconds / rounds * 1e3;
+                for (double seconds : point.phaseSeconds) csv << "," << seconds / rounds * 1e3;
+                csv << ",";
+                if (point.peakResidentKilobytes >= 0) csv << point.peakResidentKilobytes;
+                csv << ",";
+                if (point.peakHeapBytes >= 0) csv << point.peakHeapBytes;
+                csv << "\n";
+
+                std::cout << "  map " << std::setw(4) << mapSize << "  ships " << std::setw(4) << ships
+                          << "  move range " << std::fixed << std::setprecision(2) << meanRange
+                          << ": " << std::setprecision(2) << std::setw(8) << gamesPerSecond
+                          << " games/s, " << std::setprecision(3) << std::setw(9)
+                          << point.gameSeconds / rounds * 1e3 << " ms/round\n";
+            }
+        }
+    }
+
+    // fit only the dimensions the grid actually varies
+    const char* DIMENSION_NAMES[] = {"map size", "fleet size", "move range"};
+    std::vector<size_t> varied;
+    for (size_t d = 0; d < 3; ++d) {
+        for (const std::vector<double>& point : points) {
+            if (point[d] != points[0][d]) {
+                varied.push_back(d);
+                break;
+            }
+        }
+    }
+    std::cout << "Wrote " << points.size() << " sweep points to " << path << "\n";
+    if (varied.empty()) return;
+
+    std::vector<std::vector<double>> xs;
+    for (const std::vector<double>& point : points) {
+        std::vector<double> x;
+        for (size_t d : varied) x.push_back(point[d]);
+        xs.push_back(x);
+    }
+    std::vector<double> exponents = fitPowerLaw(xs, secondsPerRound);
+    std::cout << "\nFitted scaling of the time per round (time ~ dimension^exponent):\n";
+    for (size_t k = 0; k < varied.size(); ++k) {
+        std::cout << "  " << std::left << std::setw(12) << DIMENSION_NAMES[varied[k]] << std::right
+                  << std::setprecision(2) << std::setw(6) << exponents[k] << "\n";
+    }
+}
+
+// Plays the same seeded games through BatchedEnv (one env per game, --p1 as a
+// constant action) and through GameExecutor, checks that they agree and
+// compares their throughput.
+void runEnvBenchmark(size_t envCount, const std::string& p1Name, const std::string& p2Name,
+                     const RunOptions& options) {
+    StrategyParams p1 = findStrategy(p1Name);
+    StrategyParams opponent = findStrategy(p2Name);
+    std::vector<double> action = paramsToVector(p1);
+    std::vector<double> actions;
+    for (size_t i = 0; i < envCount; ++i) actions.insert(actions.end(), action.begin(), action.end());
+
+    std::cout << "Batched env: " << envCount << " envs of " << p1Name << "(P1) vs "
+              << p2Name << "(P2) on " << options.threads << " threads\n";
+
+    BatchedEnv env(envCount, opponent, options.seed, options.threads);
+    std::vector<Game::GameResult> envResults(envCount);
+    std::vector<bool> finished(envCount, false);
+    size_t finishedCount = 0;
+    uint64_t steps = 0;
+    uint64_t games = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    env.reset();
+    while (finishedCount < envCount) {
+        env.step(actions.data());
+        steps += envCount;
+        for (size_t i = 0; i < envCount; ++i) {
+            if (!env.getDones()[i]) continue;
+            ++games;
+            if (!finished[i]) {
+                finished[i] = true;
+                envResults[i] = env.getLastResult(i);
+                ++finishedCount;
+            }
+        }
+    }
+    double envSeconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+
+    std::vector<GameJob> jobs;
+    for (size_t i = 0; i < envCount; ++i) jobs.push_back({p1, opponent, mixSeed(options.seed, i, 0)});
+    startTime = std::chrono::high_resolution_clock::now();
+    std::vector<Game::GameResult> results = GameExecutor(options).run(jobs);
+    double executorSeconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < envCount; ++i) {
+        const Game::GameResult& a = envResults[i];
+        const Game::GameResult& b = results[i];
+        if (a.rounds != b.rounds || a.winner != b.winner || a.p1Ships != b.p1Ships ||
+            a.p1Health != b.p1Health || a.p2Ships != b.p2Ships || a.p2Health != b.p2Health) {
+            ++mismatches;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "  BatchedEnv    " << steps << " steps, " << games << " games in "
+              << std::setprecision(3) << envSeconds << " s: " << std::setprecision(1)
+              << steps / envSeconds << " steps/s, " << games / envSeconds << " games/s\n"
+              << "  GameExecutor  " << envCount << " games in " << std::setprecision(3)
+              << executorSeconds << " s: " << std::setprecision(1)
+              << envCount / executorSeconds << " games/s\n"
+              << "  " << (mismatches == 0 ? "All " + std::to_string(envCount) + " game results match"
+                                          : std::to_string(mismatches) + " game results differ")
+              << "\n";
+}
+
+void runRecordReplay(const std::string& path, const std::string& p1Name,
+                     const std::string& p2Name, uint64_t seed) {
+    BasicGame<ReplayRecorder> game(findStrategy(p1Name), findStrategy(p2Name), seed);
+    ReplayRecorder recorder(game);
+    game.setObserver(&recorder);
+    Game::GameResult result = game.run();
+    recorder.save(path);
+
+    std::cout << "Recorded " << p1Name << "(P1) vs " << p2Name << "(P2), seed " << seed
+              << ": " << result.rounds << " rounds, winner " << result.winner << ", "
+              << recorder.getBytes().size() << " bytes written to " << path << "\n";
+}
+
+void runWatchedGame(const std::string& p1Name, const std::string& p2Name, uint64_t seed) {
+    BasicGame<ConsoleObserver> game(findStrategy(p1Name), findStrategy(p2Name), seed);
+    ConsoleObserver console(game);
+    game.setObserver(&console);
+    std::cout << "Game Start! " << p1Name << "(P1) vs " << p2Name << "(P2), seed " << seed << "\n\n";
+    game.run();
+}
+
+void runReplay(const std::string& path, int round) {
+    auto start = std::chrono::high_resolution_clock::now();
+    Replay replay = Replay::load(path);
+    ReplayState state = replay.stateAt(round < 0 ? replay.getRoundCount() : round);
+    double seconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Replay of seed " << replay.getSeed() << ", " << replay.getRoundCount()
+              << " rounds, rebuilt in " << std::fixed << std::setprecision(6)
+              << seconds << " seconds\n";
+    printReplayState(state);
+}
+
+namespace {
+
+// Fixed seeded games whose phase hashes are pinned in golden_hashes.txt. The
+// standard games all run into the round cap, which ends them after P1_RESOLVE
+// of the last round. The two games on a 32x32 map end early instead: one after
+// P2_RESOLVE, with its round already closed, and one after P1_RESOLVE, where
+// finish() closes the open round.
+struct GoldenScenario {
+    uint64_t seed;
+    std::string p1;
+    std::string p2;
+    GameConfig config = GameConfig();
+};
+
+GameConfig smallMapConfig() {
+    GameConfig config;
+    config.mapSize = 32;
+    return config;
+}
+
+const std::vector<GoldenScenario> GOLDEN_SCENARIOS = {
+    {1, "Aggressive", "Balanced"},
+    {2, "Defensive", "Aggressive"},
+    {3, "RL_Player1_v2", "RL_Player2_v2"},
+    {4, "RL_Player1", "RL_Player2"},
+    {5, "Balanced", "RL_Player1_v2"},
+    {6, "RL_Player2", "Defensive"},
+    {54, "Aggressive", "RL_Player2", smallMapConfig()},
+    {167, "RL_Player2", "Balanced", smallMapConfig()},
+};
+
+}  // namespace
+
+// Plays the golden scenarios and either rewrites the golden file or compares
+// against it, reporting the first phase whose hash differs. Returns false on
+// any mismatch.
+bool runGoldenHashes(const std::string& path, bool update) {
+    std::vector<std::vector<StateHasher::PhaseHash>> played;
+    for (const GoldenScenario& scenario : GOLDEN_SCENARIOS) {
+        BasicGame<StateHasher> game(findStrategy(scenario.p1), findStrategy(scenario.p2),
+                                    scenario.seed, scenario.config);
+        StateHasher hasher(game);
+        game.setObserver(&hasher);
+        game.run();
+        played.push_back(hasher.getPhases());
+    }
+
+    if (update) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("cannot write " + path);
+        }
+        out << "# golden phase hashes, regenerate with --golden-update after an intended change\n";
+        out << "# scenario <seed> <p1> <p2> <map size> <fleet scale> <phase count>, then\n"
+            << "# <round> <phase> <hash> per phase\n";
+        for (size_t s = 0; s < GOLDEN_SCENARIOS.size(); ++s) {
+            const GoldenScenario& scenario = GOLDEN_SCENARIOS[s];
+            out << "scenario " << scenario.seed << " " << scenario.p1 << " " << scenario.p2
+                << " " << scenario.config.mapSize << " " << scenario.config.fleetScale << " "
+                << played[s].size() << "\n";
+            for (const StateHasher::PhaseHash& phase : played[s]) {
+                out << phase.round << " " << static_cast<int>(phase.phase) << " "
+                    << std::hex << std::setw(16) << std::setfill('0') << phase.hash
+                    << std::dec << std::setfill(' ') << "\n";
+            }
+        }
+        std::cout << "Wrote golden hashes for " << GOLDEN_SCENARIOS.size()
+                  << " scenarios to " << path << "\n";
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open golden file " + path);
+    }
+
+    bool allMatch = true;
+    std::string line;
+    size_t s = 0;
+    while (s < GOLDEN_SCENARIOS.size() && std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream header(line);
+        std::string keyword, p1, p2;
+        uint64_t seed;
+        int mapSize, fleetScale;
+        size_t phaseCount;
+        header >> keyword >> seed >> p1 >> p2 >> mapSize >> fleetScale >> phaseCount;
+        const GoldenScenario& scenario = GOLDEN_SCENARIOS[s];
+        if (!header || keyword != "scenario" || seed != scenario.seed || p1 != scenario.p1 ||
+            p2 != scenario.p2 || mapSize != scenario.config.mapSize ||
+            fleetScale != scenario.config.fleetScale) {
+            throw std::runtime_error(path + " does not match the built-in scenarios");
+        }
+
+        std::vector<StateHasher::PhaseHash> expected(phaseCount);
+        for (StateHasher::PhaseHash& phase : expected) {
+            int phaseId;
+            in >> phase.round >> phaseId >> std::hex >> phase.hash >> std::dec;
+            phase.phase = static_cast<GamePhase>(phaseId);
+        }
+        std::getline(in, line);
+
+        const std::vector<StateHasher::PhaseHash>& actual = played[s];
+        std::cout << "Scenario " << s + 1 << " (seed " << seed << ", " << p1 << " vs " << p2
+                  << "): ";
+        size_t common = std::min(expected.size(), actual.size());
+        size_t diverged = common;
+        for (size_t i = 0; i < common; ++i) {
+            if (expected[i].hash != actual[i].hash) {
+                diverged = i;
+                break;
+            }
+        }
+
+        if (diverged == common && expected.size() == actual.size()) {
+            std::cout << "OK (" << actual.size() << " phases)\n";
+        } else if (diverged < common) {
+            const StateHasher::PhaseHash& phase = expected[diverged];
+            std::cout << "MISMATCH at round " << phase.round << ", phase "
+                      << PHASE_NAMES[static_cast<int>(phase.phase)] << " (phase "
+                      << diverged << " of " << expected.size() << ")\n";
+            allMatch = false;
+        } else {
+            std::cout << "MISMATCH, game lasted " << actual.size() << " phases instead of "
+                      << expected.size() << "\n";
+            allMatch = false;
+        }
+        ++s;
+    }
+    if (s != GOLDEN_SCENARIOS.size()) {
+        throw std::runtime_error(path + " is missing scenarios");
+    }
+
+    std::cout << (allMatch ? "All golden hashes match\n" : "Golden hash check FAILED\n");
+    return allMatch;
+}
+
+// Plays the golden scenarios round by round and checks every steady-state
+// round, i.e. after the first `warmup` rounds, against the allocation budgets
+// (negative budgets are not checked). Returns false if any round exceeds one.
+bool runAllocationBudget(int64_t allocationBudget, int64_t byteBudget, int warmup) {
+#ifndef TBS_WORK_COUNTERS
+    (void)allocationBudget;
+    (void)byteBudget;
+    (void)warmup;
+    throw std::runtime_error("--alloc-budget needs a build configured with -DTBS_WORK_COUNTERS=ON");
+#else
+    // without the allocation hook every round would pass with zero allocations
+    AllocationCounts before = threadAllocationCounts();
+    void* volatile probe = ::operator new(1);
+    ::operator delete(probe);
+    if ((threadAllocationCounts() - before).allocations == 0) {
+        throw std::runtime_error("--alloc-budget needs src/allocation_hook.cpp linked into the program");
+    }
+
+    const int MAX_REPORTED_ROUNDS = 3;
+    std::cout << "Allocation budget per steady-state round (after " << warmup << " warm-up rounds): "
+              << (allocationBudget < 0 ? std::string("any") : std::to_string(allocationBudget))
+              << " allocations, "
+              << (byteBudget < 0 ? std::string("any") : std::to_string(byteBudget)) << " bytes\n";
+
+    bool withinBudget = true;
+    for (size_t s = 0; s < GOLDEN_SCENARIOS.size(); ++s) {
+        const GoldenScenario& scenario = GOLDEN_SCENARIOS[s];
+        Game game(findStrategy(scenario.p1), findStrategy(scenario.p2), scenario.seed,
+                  scenario.config);
+
+        std::array<AllocationCounts, TIMED_PHASE_COUNT> phases{};
+        auto play = [&](GamePhase phase) {
+            AllocationCounts before = threadAllocationCounts();
+            game.playPhase(phase);
+            phases[static_cast<int>(phase) - 1] = threadAllocationCounts() - before;
+        };
+
+        int checkedRounds = 0, overRounds = 0, worstRound = 0;
+        AllocationCounts worst;
+        std::ostringstream failures;
+        game.start();
+        while (!game.isGameOver()) {
+            game.beginRound();
+            phases = {};
+            play(GamePhase::P1_ATTACK_CHOICE);
+            play(GamePhase::P2_MOVE);
+            play(GamePhase::P1_RESOLVE);
+            if (!game.isGameOver()) {
+                play(GamePhase::P2_ATTACK_CHOICE);
+                play(GamePhase::P1_MOVE);
+                play(GamePhase::P2_RESOLVE);
+            }
+            if (game.getRound() <= warmup) continue;
+
+            AllocationCounts total;
+            for (const AllocationCounts& counts : phases) total += counts;
+            ++checkedRounds;
+            if (total.allocations > worst.allocations) {
+                worst = total;
+                worstRound = game.getRound();
+            }
+            bool over = (allocationBudget >= 0 && total.allocations > static_cast<uint64_t>(allocationBudget)) ||
+                        (byteBudget >= 0 && total.bytes > static_cast<uint64_t>(byteBudget));
+            if (!over) continue;
+
+            if (++overRounds <= MAX_REPORTED_ROUNDS) {
+                failures << "    round " << game.getRound() << ": " << total.allocations
+                         << " allocations, " << total.bytes << " bytes (";
+                for (int phase = 0; phase < TIMED_PHASE_COUNT; ++phase) {
+                    failures << (phase ? ", " : "") << PHASE_NAMES[phase + 1] << " "
+                             << phases[phase].allocations;
+                }
+                failures << ")\n";
+            }
+        }
+
+        std::cout << "Scenario " << s + 1 << " (seed " << scenario.seed << ", " << scenario.p1
+                  << " vs " << scenario.p2 << "): " << checkedRounds << " rounds checked, worst "
+                  << worst.allocations << " allocations / " << worst.bytes << " bytes";
+        if (worstRound > 0) std::cout << " in round " << worstRound;
+        if (overRounds == 0) {
+            std::cout << ": OK\n";
+        } else {
+            std::cout << ": " << overRounds << " rounds OVER BUDGET\n" << failures.str();
+            withinBudget = false;
+        }
+    }
+
+    std::cout << (withinBudget ? "All steady-state rounds are within the allocation budget\n"
+                               : "Allocation budget check FAILED\n");
+    return withinBudget;
+#endif
+}
+
+}  // namespace tbs